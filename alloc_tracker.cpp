@@ -0,0 +1,62 @@
+// alloc_tracker.cpp
+//
+// Global operator new/delete replacement behind -DDT_TRACK_ALLOCATIONS=ON. Each block
+// carries a small header with its size and subsystem, so frees are credited back to the
+// subsystem that allocated them, whichever scope the delete happens in.
+
+#include "alloc_tracker.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct BlockHeader {
+    size_t bytes;
+    size_t offset;                  // distance from the malloc'd base to the user pointer
+    AllocSubsystem subsystem;
+};
+
+// Header space rounded up so the user pointer keeps the requested alignment
+constexpr size_t headerSpace(size_t align) {
+    size_t h = (sizeof(BlockHeader) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    return align > h ? align : (h + align - 1) / align * align;
+}
+
+void* trackedAlloc(size_t bytes, size_t align) {
+    if (align < alignof(std::max_align_t)) align = alignof(std::max_align_t);
+    size_t offset = headerSpace(align);
+    void *base = align > alignof(std::max_align_t)
+        ? std::aligned_alloc(align, (offset + bytes + align - 1) / align * align)
+        : std::malloc(offset + bytes);
+    if (!base) throw std::bad_alloc();
+    auto *user = static_cast<unsigned char*>(base) + offset;
+    auto *header = reinterpret_cast<BlockHeader*>(user - sizeof(BlockHeader));
+    *header = {bytes, offset, currentAllocSubsystem};
+    AllocTracker::global().onAlloc(bytes, header->subsystem);
+    return user;
+}
+
+void trackedFree(void *p) noexcept {
+    if (!p) return;
+    auto *user = static_cast<unsigned char*>(p);
+    auto *header = reinterpret_cast<BlockHeader*>(user - sizeof(BlockHeader));
+    AllocTracker::global().onFree(header->bytes, header->subsystem);
+    std::free(user - header->offset);
+}
+
+}
+
+void* operator new(size_t bytes) { return trackedAlloc(bytes, 0); }
+void* operator new[](size_t bytes) { return trackedAlloc(bytes, 0); }
+void* operator new(size_t bytes, std::align_val_t align) { return trackedAlloc(bytes, static_cast<size_t>(align)); }
+void* operator new[](size_t bytes, std::align_val_t align) { return trackedAlloc(bytes, static_cast<size_t>(align)); }
+void operator delete(void *p) noexcept { trackedFree(p); }
+void operator delete[](void *p) noexcept { trackedFree(p); }
+void operator delete(void *p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void *p, size_t) noexcept { trackedFree(p); }
+void operator delete(void *p, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { trackedFree(p); }
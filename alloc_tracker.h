@@ -0,0 +1,147 @@
+// alloc_tracker.h
+//
+// Opt-in heap accounting per subsystem and pipeline phase. Configure with
+// -DDT_TRACK_ALLOCATIONS=ON to link the operator new hook in alloc_tracker.cpp; every
+// allocation is then charged to the innermost AllocScope on its thread and to the phase
+// PhaseTimer is timing. In normal builds AllocScope is an empty object.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include "metrics.h"
+
+enum class AllocSubsystem : uint8_t { Other, Loader, Dictionary, TrainingScratch, TreeNodes, Predictor, Count };
+
+// Subsystem charged for allocations made on this thread
+inline thread_local AllocSubsystem currentAllocSubsystem = AllocSubsystem::Other;
+
+// ————————————————————————————————————————————————————————————————————————————————
+// AllocTracker: relaxed counters per (phase, subsystem), live and peak live bytes per
+// subsystem, and the peak live heap seen while each phase was running.
+// ————————————————————————————————————————————————————————————————————————————————
+class AllocTracker {
+public:
+    static constexpr size_t PhaseSlots = static_cast<size_t>(Metrics::Phase::Count) + 1;   // last = no phase
+    static constexpr size_t SubsystemSlots = static_cast<size_t>(AllocSubsystem::Count);
+
+    static AllocTracker& global() {
+        static AllocTracker instance;
+        return instance;
+    }
+
+    static constexpr bool enabled() {
+#ifdef DT_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void onAlloc(size_t bytes, AllocSubsystem sub) {
+        auto s = static_cast<size_t>(sub);
+        auto &cell = cells[static_cast<size_t>(currentPhase)][s];
+        cell.allocs.fetch_add(1, std::memory_order_relaxed);
+        cell.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        raise(subsystems[s].peak, subsystems[s].live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        uint64_t total = liveTotal.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        raise(phasePeak[static_cast<size_t>(currentPhase)], total);
+    }
+
+    void onFree(size_t bytes, AllocSubsystem sub) {
+        subsystems[static_cast<size_t>(sub)].live.fetch_sub(bytes, std::memory_order_relaxed);
+        liveTotal.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void writeReport(std::ostream &out) const {
+        if (!enabled()) {
+            out << "Allocation tracking is not compiled in (configure with -DDT_TRACK_ALLOCATIONS=ON)\n";
+            return;
+        }
+        out << "Allocations by phase:\n"
+            << std::left << std::setw(14) << "  phase" << std::right
+            << std::setw(12) << "allocs" << std::setw(16) << "bytes" << std::setw(15) << "peak live" << "\n";
+        for (size_t p = 0; p < PhaseSlots; ++p) {
+            uint64_t allocs = 0, bytes = 0;
+            for (auto const &c : cells[p]) {
+                allocs += c.allocs.load(std::memory_order_relaxed);
+                bytes += c.bytes.load(std::memory_order_relaxed);
+            }
+            if (allocs == 0) continue;
+            out << "  " << std::left << std::setw(12) << phaseName(p) << std::right
+                << std::setw(12) << allocs << std::setw(16) << bytes
+                << std::setw(15) << phasePeak[p].load(std::memory_order_relaxed) << "\n";
+        }
+
+        out << "Allocations by subsystem:\n"
+            << std::left << std::setw(20) << "  subsystem" << std::right
+            << std::setw(12) << "allocs" << std::setw(16) << "bytes"
+            << std::setw(14) << "live" << std::setw(15) << "peak live" << "\n";
+        for (size_t s = 0; s < SubsystemSlots; ++s) {
+            uint64_t allocs = 0, bytes = 0;
+            for (auto const &row : cells) {
+                allocs += row[s].allocs.load(std::memory_order_relaxed);
+                bytes += row[s].bytes.load(std::memory_order_relaxed);
+            }
+            if (allocs == 0) continue;
+            out << "  " << std::left << std::setw(18) << subsystemName(s) << std::right
+                << std::setw(12) << allocs << std::setw(16) << bytes
+                << std::setw(14) << subsystems[s].live.load(std::memory_order_relaxed)
+                << std::setw(15) << subsystems[s].peak.load(std::memory_order_relaxed) << "\n";
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+    struct Live {
+        std::atomic<uint64_t> live{0};
+        std::atomic<uint64_t> peak{0};
+    };
+
+    std::array<std::array<Cell, SubsystemSlots>, PhaseSlots> cells{};
+    std::array<Live, SubsystemSlots> subsystems{};
+    std::array<std::atomic<uint64_t>, PhaseSlots> phasePeak{};
+    std::atomic<uint64_t> liveTotal{0};
+
+    static void raise(std::atomic<uint64_t> &peak, uint64_t value) {
+        uint64_t prev = peak.load(std::memory_order_relaxed);
+        while (value > prev && !peak.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+    }
+
+    static const char* phaseName(size_t p) {
+        return p < static_cast<size_t>(Metrics::Phase::Count) ? Metrics::phaseName(static_cast<Metrics::Phase>(p)) : "(none)";
+    }
+
+    static const char* subsystemName(size_t s) {
+        static const char *names[] = {"other", "loader", "dictionary", "training_scratch", "tree_nodes", "predictor"};
+        return names[s];
+    }
+};
+
+// Charges the allocations of the current scope to a subsystem; nests, and restores the
+// outer subsystem on exit
+class AllocScope {
+public:
+#ifdef DT_TRACK_ALLOCATIONS
+    explicit AllocScope(AllocSubsystem sub)
+        : previous(currentAllocSubsystem) {
+        currentAllocSubsystem = sub;
+    }
+    ~AllocScope() { currentAllocSubsystem = previous; }
+#else
+    explicit AllocScope(AllocSubsystem) {}
+#endif
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+#ifdef DT_TRACK_ALLOCATIONS
+    AllocSubsystem previous;
+#endif
+};
@@ -0,0 +1,465 @@
+// bench.cpp
+//
+// Microbenchmarks for the hot kernels: CSV tokenizing, entropy, information gain,
+// partitioning, tree building and prediction. Each benchmark reports the median ns/op
+// over several repetitions plus heap bytes and allocations per op, measured by
+// replacing the global operator new in this executable only, and the peak RSS reached
+// while each dataset was benchmarked. With --perf-counters, hardware counters per op are
+// added for the whole benchmark and for each instrumented region it passes through
+// (split search, partition, predict); where perf_event_open is not permitted the
+// benchmarks run without them.
+//
+//   tree_bench [--data DIR] [--filter TEXT] [--min-time SECONDS] [--repetitions N]
+//              [--gen ROWSxCOLSxCARD]... [--perf-counters] [--json PATH]
+//
+// Runs on weather.csv, contact_lenses.csv and breast_cancer.csv from DIR (default:
+// the working directory) and on generated tables with a fixed seed. Each --gen adds a
+// generated table, e.g. --gen 100000x8x16, for rows x columns x cardinality scaling runs.
+
+#include "decision_tree.h"
+#include "synth_data.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <malloc.h>
+#include <sys/resource.h>
+
+// ————————————————————————————————————————————————————————————————————————————————
+// Allocation accounting: every global new in this process bumps two relaxed counters.
+// ————————————————————————————————————————————————————————————————————————————————
+static atomic<uint64_t> allocCount{0};
+static atomic<uint64_t> allocBytes{0};
+
+static void* countedAlloc(size_t bytes, size_t align) {
+    allocCount.fetch_add(1, memory_order_relaxed);
+    allocBytes.fetch_add(bytes, memory_order_relaxed);
+    if (bytes == 0) bytes = 1;
+    void *p = align > alignof(max_align_t)
+        ? aligned_alloc(align, (bytes + align - 1) / align * align)
+        : malloc(bytes);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t bytes) { return countedAlloc(bytes, 0); }
+void* operator new[](size_t bytes) { return countedAlloc(bytes, 0); }
+void* operator new(size_t bytes, align_val_t align) { return countedAlloc(bytes, static_cast<size_t>(align)); }
+void* operator new[](size_t bytes, align_val_t align) { return countedAlloc(bytes, static_cast<size_t>(align)); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, align_val_t) noexcept { free(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { free(p); }
+
+// Reset the kernel's high-water mark (VmHWM) to the current RSS; Linux only, best effort.
+// Free heap from the previous dataset is handed back first, or it would stay resident
+// and count towards the next dataset's peak.
+static void resetPeakRss() {
+    malloc_trim(0);
+    ofstream clear("/proc/self/clear_refs");
+    if (clear.is_open()) clear << "5";
+}
+
+// Peak RSS in KB since the last reset, or since process start where resets are unsupported
+static long peakRssKb() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return stol(line.substr(6));
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Keeps a result alive so the optimizer cannot drop the work that produced it
+template <class T>
+static void keep(T const &value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// The training kernels narrate every step to cout; benchmarks time them with the
+// narration formatted but discarded.
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+struct BenchOptions {
+    string dataDir = ".";
+    string filter;
+    double minTime = 0.2;           // seconds per repetition
+    int repetitions = 5;
+    vector<string> generated{"1000x6x4", "10000x8x8"};
+    bool perfCounters = false;
+    string jsonPath;
+};
+
+struct BenchResult {
+    string name;
+    string dataset;
+    uint64_t iterations = 0;        // ops per repetition
+    double nsPerOp = 0.0;           // median over repetitions
+    double minNsPerOp = 0.0;
+    double bytesPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    // Hardware counters per op over all repetitions: [0] the whole benchmark, then one
+    // entry per region it entered; empty when counters are off
+    vector<pair<string, PerfCounters::Sample>> counters;
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// Runner: grows the call count until one repetition lasts minTime, then measures.
+// `body` performs opsPerCall operations per call.
+// ————————————————————————————————————————————————————————————————————————————————
+class BenchRunner {
+public:
+    BenchRunner(const BenchOptions &options, ostream &report)
+        : options(options), report(report) {}
+
+    void run(const string &name, const string &dataset, uint64_t opsPerCall, const function<void()> &body) {
+        string full = name + "/" + dataset;
+        if (!options.filter.empty() && full.find(options.filter) == string::npos) return;
+
+        using clock = chrono::steady_clock;
+        body();                                             // warm caches and lazy state
+        uint64_t calls = 1;
+        while (true) {
+            auto start = clock::now();
+            for (uint64_t i = 0; i < calls; ++i) body();
+            double elapsed = chrono::duration<double>(clock::now() - start).count();
+            if (elapsed >= options.minTime || calls >= (1ull << 30)) break;
+            double scale = elapsed > 0 ? options.minTime / elapsed * 1.2 : 10.0;
+            calls = max(calls + 1, static_cast<uint64_t>(static_cast<double>(calls) * min(scale, 10.0)));
+        }
+
+        vector<double> samples;
+        uint64_t allocs = 0, bytes = 0;
+        auto &perf = PerfCounters::global();
+        PerfCounters::Sample counterStart, counterEnd;
+        array<PerfCounters::Sample, PerfCounters::RegionCount> regionStart;
+        array<uint64_t, PerfCounters::RegionCount> entriesStart{};
+        bool counting = perf.isEnabled() && perf.read(counterStart);
+        for (int r = 0; counting && r < PerfCounters::RegionCount; ++r) {
+            regionStart[r] = perf.total(static_cast<PerfCounters::Region>(r));
+            entriesStart[r] = perf.entries(static_cast<PerfCounters::Region>(r));
+        }
+        for (int r = 0; r < options.repetitions; ++r) {
+            uint64_t allocsBefore = allocCount.load(memory_order_relaxed);
+            uint64_t bytesBefore = allocBytes.load(memory_order_relaxed);
+            auto start = clock::now();
+            for (uint64_t i = 0; i < calls; ++i) body();
+            double ns = chrono::duration<double, nano>(clock::now() - start).count();
+            allocs = allocCount.load(memory_order_relaxed) - allocsBefore;
+            bytes = allocBytes.load(memory_order_relaxed) - bytesBefore;
+            samples.push_back(ns / static_cast<double>(calls * opsPerCall));
+        }
+        counting = counting && perf.read(counterEnd);
+        sort(samples.begin(), samples.end());
+
+        BenchResult result;
+        result.name = name;
+        result.dataset = dataset;
+        result.iterations = calls * opsPerCall;
+        result.nsPerOp = samples[samples.size() / 2];
+        result.minNsPerOp = samples.front();
+        result.bytesPerOp = static_cast<double>(bytes) / static_cast<double>(result.iterations);
+        result.allocsPerOp = static_cast<double>(allocs) / static_cast<double>(result.iterations);
+        if (counting) {
+            uint64_t ops = result.iterations * static_cast<uint64_t>(options.repetitions);
+            result.counters.emplace_back("total", perOp(counterStart, counterEnd, ops));
+            for (int r = 0; r < PerfCounters::RegionCount; ++r) {
+                auto region = static_cast<PerfCounters::Region>(r);
+                if (perf.entries(region) == entriesStart[r]) continue;
+                result.counters.emplace_back(PerfCounters::regionName(region),
+                                             perOp(regionStart[r], perf.total(region), ops));
+            }
+        }
+        results.push_back(result);
+
+        report << left << setw(28) << name << setw(22) << dataset << right
+               << fixed << setprecision(1)
+               << setw(14) << result.nsPerOp << " ns/op"
+               << setw(12) << result.bytesPerOp << " B/op"
+               << setw(10) << setprecision(2) << result.allocsPerOp << " allocs/op\n";
+        for (auto const &[region, c] : result.counters) {
+            report << "  " << left << setw(26) << region << right << setprecision(1);
+            for (int e = 0; e < PerfCounters::EventCount; ++e) {
+                auto event = static_cast<PerfCounters::Event>(e);
+                report << "  " << PerfCounters::eventName(event) << " ";
+                if (c.has(event)) report << c.value[e];
+                else report << "n/a";
+            }
+            if (c.has(PerfCounters::Cycles) && c.has(PerfCounters::Instructions) && c.value[PerfCounters::Cycles])
+                report << "  ipc " << setprecision(2)
+                       << static_cast<double>(c.value[PerfCounters::Instructions]) / c.value[PerfCounters::Cycles];
+            report << "\n";
+        }
+        report.flush();
+    }
+
+    // Record the peak RSS of a dataset if any of its benchmarks ran
+    void datasetDone(const string &dataset, long peakKb) {
+        bool ran = any_of(results.begin(), results.end(), [&](const BenchResult &r) { return r.dataset == dataset; });
+        if (!ran) return;
+        datasets.emplace_back(dataset, peakKb);
+        report << left << setw(28) << "peak RSS" << setw(22) << dataset << right
+               << setw(14) << peakKb << " KB\n";
+    }
+
+    bool writeJson(const string &path) const {
+        ofstream out(path, ios::trunc);
+        if (!out.is_open()) return false;
+        out << "{\n  \"context\": {\"repetitions\": " << options.repetitions
+            << ", \"min_time_s\": " << options.minTime
+            << ", \"perf_counters\": " << (PerfCounters::global().isEnabled() ? "true" : "false")
+            << "},\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto const &r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"dataset\": \"" << r.dataset << "\""
+                << ", \"iterations\": " << r.iterations
+                << fixed << setprecision(3)
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"min_ns_per_op\": " << r.minNsPerOp
+                << ", \"bytes_per_op\": " << r.bytesPerOp
+                << ", \"allocs_per_op\": " << r.allocsPerOp;
+            if (!r.counters.empty()) {
+                out << ", \"counters_per_op\": {";
+                for (size_t k = 0; k < r.counters.size(); ++k) {
+                    auto const &[region, c] = r.counters[k];
+                    out << (k ? ", " : "") << "\"" << region << "\": {";
+                    for (int e = 0; e < PerfCounters::EventCount; ++e) {
+                        auto event = static_cast<PerfCounters::Event>(e);
+                        out << (e ? ", " : "") << "\"" << PerfCounters::eventName(event) << "\": ";
+                        if (c.has(event)) out << c.value[e];
+                        else out << "null";
+                    }
+                    out << "}";
+                }
+                out << "}";
+            }
+            out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"datasets\": [\n";
+        for (size_t i = 0; i < datasets.size(); ++i) {
+            out << "    {\"dataset\": \"" << datasets[i].first << "\", \"peak_rss_kb\": " << datasets[i].second << "}"
+                << (i + 1 < datasets.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    const BenchOptions &options;
+    ostream &report;
+
+    // Counter deltas divided by the op count, rounded to whole events
+    static PerfCounters::Sample perOp(const PerfCounters::Sample &begin, const PerfCounters::Sample &end, uint64_t ops) {
+        PerfCounters::Sample s;
+        for (int e = 0; e < PerfCounters::EventCount; ++e) {
+            s.value[e] = begin.has(static_cast<PerfCounters::Event>(e)) && end.has(static_cast<PerfCounters::Event>(e))
+                ? (end.value[e] - begin.value[e] + ops / 2) / ops : UINT64_MAX;
+        }
+        return s;
+    }
+    vector<BenchResult> results;
+    vector<pair<string, long>> datasets;
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// TreeBench: the private DecisionTree kernels, reached through its friend declaration.
+// ————————————————————————————————————————————————————————————————————————————————
+struct TreeBench {
+    static double entropy(DecisionTree &tree, const vector<string> &labels) {
+        return tree.calculateEntropy(labels, 0);
+    }
+    static double informationGain(DecisionTree &tree, const vector<vector<string>> &table, int attr) {
+        return tree.calculateIG_OnSubset(table, attr, 0);
+    }
+    static size_t partition(const DecisionTree &tree, const vector<vector<string>> &table, int attr) {
+        return tree.partitionRows(table, attr).size();
+    }
+    // Builds into an empty scratch tree whose arena is released when the op ends
+    static bool buildTree(const vector<vector<string>> &table) {
+        DecisionTree scratch(table[0], [](NodeArena&) { return static_cast<TreeNode*>(nullptr); });
+        return scratch.buildTree(table, table[0]) != nullptr;
+    }
+};
+
+// "ROWSxCOLSxCARD" -> a seeded table with a planted depth-3 tree and 5% label noise
+static bool generateCsv(const string &shape, string &csv) {
+    SynthSpec spec;
+    char x1 = 0, x2 = 0;
+    unsigned long long rows = 0;
+    size_t cols = 0, card = 0;
+    istringstream in(shape);
+    if (!(in >> rows >> x1 >> cols >> x2 >> card) || x1 != 'x' || x2 != 'x' || cols == 0 || card == 0)
+        return false;
+    spec.rows = rows;
+    spec.attributes = cols;
+    spec.defaultCardinality = card;
+    ostringstream out;
+    SyntheticData(spec).writeCsv(out);
+    csv = out.str();
+    return true;
+}
+
+static void benchDataset(BenchRunner &runner, const string &dataset, const string &csv) {
+    vector<string> lines;
+    {
+        istringstream in(csv);
+        string line;
+        while (getline(in, line)) lines.push_back(line);
+    }
+    istringstream in(csv);
+    DataSheet sheet(in);
+    const auto &table = sheet.getData();
+    if (table.size() < 2 || table[0].size() < 2) {
+        cerr << "Skipping " << dataset << ": no data rows\n";
+        return;
+    }
+    DecisionTree tree(&sheet);
+    uint64_t rows = table.size() - 1;
+    int labelIdx = static_cast<int>(table[0].size()) - 1;
+
+    // Tokenizing: one op is one line
+    runner.run("csv/splitDelimiter", dataset, lines.size(), [&] {
+        vector<string> cells;
+        for (auto const &line : lines) {
+            DataSheet::splitDelimiter(line, cells, ',');
+            keep(cells);
+        }
+    });
+    runner.run("csv/split", dataset, lines.size(), [&] {
+        for (auto const &line : lines) {
+            auto cells = split(line, ',');
+            keep(cells);
+        }
+    });
+
+    // Training kernels on the whole table: one op is one call
+    vector<string> labels;
+    for (size_t i = 1; i < table.size(); ++i) labels.push_back(table[i][labelIdx]);
+    runner.run("train/entropy", dataset, 1, [&] {
+        double e = TreeBench::entropy(tree, labels);
+        keep(e);
+    });
+    runner.run("train/calculateIG_OnSubset", dataset, static_cast<uint64_t>(labelIdx), [&] {
+        for (int a = 0; a < labelIdx; ++a) {
+            double g = TreeBench::informationGain(tree, table, a);
+            keep(g);
+        }
+    });
+    runner.run("train/partition", dataset, 1, [&] {
+        size_t parts = TreeBench::partition(tree, table, 0);
+        keep(parts);
+    });
+    // Each build fills and frees its own arena, so bytes/op includes the nodes and peak
+    // RSS does not grow with the iteration count
+    runner.run("train/buildTree", dataset, 1, [&] {
+        bool built = TreeBench::buildTree(table);
+        keep(built);
+    });
+
+    // Prediction over every data row: one op is one row
+    const auto &headers = table[0];
+    vector<unordered_map<string, string>> inputs;
+    vector<vector<string>> batch(table.begin() + 1, table.end());
+    for (auto const &row : batch) {
+        unordered_map<string, string> input;
+        for (int c = 0; c < labelIdx; ++c) input[headers[c]] = row[c];
+        inputs.push_back(std::move(input));
+    }
+    runner.run("predict/single", dataset, rows, [&] {
+        for (auto const &input : inputs) {
+            string lab = tree.predict(input);
+            keep(lab);
+        }
+    });
+    runner.run("predict/batch", dataset, rows, [&] {
+        auto out = tree.predictBatch(batch);
+        keep(out);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions opt;
+    bool generatedSet = false;
+    for (int i = 1; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--perf-counters") {
+            opt.perfCounters = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Usage: " << argv[0] << " [--data DIR] [--filter TEXT] [--min-time SECONDS]"
+                 << " [--repetitions N] [--gen ROWSxCOLSxCARD]... [--perf-counters] [--json PATH]\n";
+            return 1;
+        }
+        string value = argv[++i];
+        if (flag == "--data") opt.dataDir = value;
+        else if (flag == "--filter") opt.filter = value;
+        else if (flag == "--min-time") {
+            if (!parseNumber(flag, value, opt.minTime)) return 1;
+            opt.minTime = max(0.001, opt.minTime);
+        }
+        else if (flag == "--repetitions") {
+            if (!parseNumber(flag, value, opt.repetitions)) return 1;
+            opt.repetitions = max(1, opt.repetitions);
+        }
+        else if (flag == "--json") opt.jsonPath = value;
+        else if (flag == "--gen") {
+            if (!generatedSet) opt.generated.clear();
+            generatedSet = true;
+            opt.generated.push_back(value);
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+    if (opt.perfCounters && !PerfCounters::global().enable())
+        cerr << "Hardware counters unavailable, continuing without them: "
+             << PerfCounters::global().unavailableReason() << "\n";
+
+    ostream report(cout.rdbuf());
+    NullBuffer discard;
+    cout.rdbuf(&discard);
+    BenchRunner runner(opt, report);
+
+    for (string name : {"weather.csv", "contact_lenses.csv", "breast_cancer.csv"}) {
+        ifstream file(opt.dataDir + "/" + name);
+        if (!file.is_open()) {
+            cerr << "Skipping " << name << ": not found in " << opt.dataDir << "\n";
+            continue;
+        }
+        stringstream csv;
+        csv << file.rdbuf();
+        resetPeakRss();
+        benchDataset(runner, name, csv.str());
+        runner.datasetDone(name, peakRssKb());
+    }
+    for (auto const &shape : opt.generated) {
+        string csv;
+        if (!generateCsv(shape, csv)) {
+            cerr << "Skipping --gen " << shape << ": expected ROWSxCOLSxCARD\n";
+            continue;
+        }
+        resetPeakRss();
+        benchDataset(runner, "gen-" + shape, csv);
+        runner.datasetDone("gen-" + shape, peakRssKb());
+    }
+
+    cout.rdbuf(report.rdbuf());
+    if (!opt.jsonPath.empty() && !runner.writeJson(opt.jsonPath)) {
+        cerr << "Could not write " << opt.jsonPath << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+// cli.cpp
+//
+// dtree: the GUI-free command line for batch jobs. Links only the core headers.
+
+#include "commands.h"
+
+int main(int argc, char *argv[]) {
+    int status = runCommand(argc, argv);
+    if (status >= 0) return status;
+    printUsage(argv[0]);
+    return 1;
+}
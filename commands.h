@@ -0,0 +1,790 @@
+// commands.h
+//
+// Subcommands shared by the dtree CLI and the CPLHW1 viewer. Each takes the full argv
+// (argv[1] is the subcommand name) and returns the process exit code. Data arguments
+// accept "-" for stdin, so the commands compose as pipeline stages.
+
+#pragma once
+
+#include "decision_tree.h"
+#include "tree_export.h"
+#include "external_training.h"
+#include "hoeffding_tree.h"
+#include "incremental_training.h"
+
+#include <map>
+
+// "-" reads stdin; otherwise the file is opened into `file`
+inline istream* openInput(const string &path, ifstream &file) {
+    if (path == "-") return &cin;
+    file.open(path);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << path << "\n";
+        return nullptr;
+    }
+    return &file;
+}
+
+// Split a line into views of its fields
+inline void splitFields(string_view line, char delimiter, vector<string_view> &out) {
+    out.clear();
+    size_t start = 0;
+    while (true) {
+        size_t pos = line.find(delimiter, start);
+        if (pos == string_view::npos) {
+            out.push_back(line.substr(start));
+            return;
+        }
+        out.push_back(line.substr(start, pos - start));
+        start = pos + 1;
+    }
+}
+
+inline bool parseDelimiter(const string &value, char &delimiter) {
+    if (value == "\\t" || value == "tab") delimiter = '\t';
+    else if (value.size() == 1) delimiter = value[0];
+    else {
+        cerr << "Expected a single delimiter character, got \"" << value << "\"\n";
+        return false;
+    }
+    return true;
+}
+
+// ————————————————————————————————————————————————————————————————————————————————
+// ModelRowReader: streams a delimited file in batches and presents each row with its
+// fields in the model's attribute order, so it can be scored without loading the whole
+// file. Columns are matched to attributes by header name; the label column is the last
+// one, as in training. Rows stay valid until the next call to next().
+// ————————————————————————————————————————————————————————————————————————————————
+class ModelRowReader {
+public:
+    ModelRowReader(istream &in, char delimiter)
+        : in(in), delimiter(delimiter) {}
+
+    // Read the header; false (with a message on cerr) if a model attribute is missing
+    bool open(const MappedModel &model) {
+        string header;
+        if (!getline(in, header)) {
+            cerr << "Input is empty, expected a header line\n";
+            return false;
+        }
+        vector<string_view> names;
+        splitFields(header, delimiter, names);
+        labelColumn = names.size() - 1;
+        columns.clear();
+        for (size_t a = 0; a < model.attributeCount(); ++a) {
+            auto it = find(names.begin(), names.end(), model.attribute(static_cast<uint32_t>(a)));
+            if (it == names.end()) {
+                cerr << "Input has no column \"" << model.attribute(static_cast<uint32_t>(a))
+                     << "\" required by the model\n";
+                return false;
+            }
+            columns.push_back(static_cast<size_t>(it - names.begin()));
+        }
+        return true;
+    }
+
+    // Read up to maxRows rows; false once the input is exhausted
+    bool next(size_t maxRows) {
+        lines.resize(maxRows);
+        size_t n = 0;
+        while (n < maxRows && getline(in, lines[n])) {
+            if (!lines[n].empty() && lines[n].back() == '\r') lines[n].pop_back();
+            if (!lines[n].empty()) ++n;
+        }
+        batch.resize(n);
+        labelValues.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            splitFields(lines[i], delimiter, fields);
+            batch[i].resize(columns.size());
+            for (size_t a = 0; a < columns.size(); ++a)
+                batch[i][a] = columns[a] < fields.size() ? fields[columns[a]] : string_view{};
+            labelValues[i] = labelColumn < fields.size() ? fields[labelColumn] : string_view{};
+        }
+        return n > 0;
+    }
+
+    const vector<vector<string_view>>& rows() const { return batch; }
+    const vector<string_view>& labels() const { return labelValues; }
+
+private:
+    istream &in;
+    char delimiter;
+    vector<size_t> columns;                 // input column of each model attribute
+    size_t labelColumn = 0;
+    vector<string> lines;
+    vector<string_view> fields;
+    vector<vector<string_view>> batch;
+    vector<string_view> labelValues;
+};
+
+// dtree train <data.csv | -> <model.bin> [--delimiter C] [--verbose] [--print-data]
+//             [--print-tree] [--metrics-file PATH] [--trace PATH] [--memory-report]
+//             [--progress SECONDS] [--external [--memory-budget MB] [--temp-dir DIR]]
+//             [--profile HOLDOUT.csv] [--live]
+// Quiet by default: --verbose narrates the split search on stderr, --print-data and
+// --print-tree write the dataset and the tree to stdout. --external trains out of core
+// (see external_training.h) within --memory-budget. --profile scores a representative
+// holdout and saves the nodes in the order its hot paths visit them
+// (FlatTree::optimizeLayout). --live (CPLHW1 only) opens the viewer on the tree while it
+// is being built.
+inline int trainModel(int argc, char *argv[]) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " train <data.csv | -> <model.bin> [--delimiter C] [--verbose]"
+             << " [--print-data] [--print-tree] [--metrics-file PATH] [--trace PATH]"
+             << " [--memory-report] [--progress SECONDS] [--external [--memory-budget MB] [--temp-dir DIR]]"
+             << " [--profile HOLDOUT.csv]"
+#ifdef DT_WITH_SFML
+             << " [--live]"
+#endif
+             << "\n";
+        return 1;
+    }
+    string metricsPath, tracePath, profilePath;
+    bool memoryReport = false, printData = false, printTree = false, external = false;
+    double progressSeconds = 0.0;
+    char delimiter = ',';
+    ExternalOptions externalOptions;
+#ifdef DT_WITH_SFML
+    bool live = false;
+#endif
+    for (int i = 4; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--memory-report") memoryReport = true;
+        else if (flag == "--verbose") TrainingLog::global().out = &cerr;
+        else if (flag == "--print-data") printData = true;
+        else if (flag == "--print-tree") printTree = true;
+        else if (flag == "--external") external = true;
+#ifdef DT_WITH_SFML
+        else if (flag == "--live") live = true;
+#endif
+        else if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else if (flag == "--memory-budget") {
+            double megabytes = 0;
+            if (!parseNumber(flag, argv[++i], megabytes)) return 1;
+            externalOptions.memoryBudget = static_cast<size_t>(max(1.0, megabytes) * 1024 * 1024);
+        }
+        else if (flag == "--temp-dir") externalOptions.tempDir = argv[++i];
+        else if (flag == "--profile") profilePath = argv[++i];
+        else if (flag == "--metrics-file") metricsPath = argv[++i];
+        else if (flag == "--trace") tracePath = argv[++i];
+        else if (flag == "--progress") {
+            if (!parseNumber(flag, argv[++i], progressSeconds)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+    if (!tracePath.empty()) TraceRecorder::global().enable();
+
+#ifdef DT_WITH_SFML
+    if (external && live) {
+        cerr << "--live follows the in-memory builder and cannot be combined with --external\n";
+        return 1;
+    }
+#endif
+    if (external && printData) {
+        cerr << "--print-data needs the data in memory and cannot be combined with --external\n";
+        return 1;
+    }
+
+    ifstream file;
+    istream *in = openInput(argv[2], file);
+    if (!in) return 1;
+    auto startReporter = [&] {
+        unique_ptr<ProgressReporter> reporter;
+        if (progressSeconds > 0)
+            reporter = make_unique<ProgressReporter>(cerr, chrono::milliseconds(static_cast<long>(progressSeconds * 1000)));
+        return reporter;
+    };
+    unique_ptr<DecisionTree> tree;
+    if (external) {
+        externalOptions.delimiter = delimiter;
+        ExternalTrainer trainer(externalOptions);
+        if (!trainer.encode(*in)) return 1;
+        auto reporter = startReporter();
+        tree = trainer.train();
+        if (!tree) return 1;
+    } else {
+        DataSheet data(*in, delimiter);
+        if (printData) data.printData();
+        auto reporter = startReporter();
+#ifdef DT_WITH_SFML
+        if (live) tree = trainWithLiveView(&data);
+#endif
+        if (!tree) tree = make_unique<DecisionTree>(&data);
+    }
+    if (printTree) tree->printTree();
+    if (!profilePath.empty()) {
+        ifstream holdoutFile;
+        istream *holdoutIn = openInput(profilePath, holdoutFile);
+        if (!holdoutIn) return 1;
+        DataSheet holdout(*holdoutIn, delimiter);
+        tree->optimizeLayout(tree->profileVisits(holdout));
+    }
+    if (!tree->saveModel(argv[3])) return 1;
+    if (memoryReport) {
+        tree->printMemoryUsage();
+        AllocTracker::global().writeReport(cout);
+    }
+    if (!metricsPath.empty() && !Metrics::global().dumpPrometheus(metricsPath)) {
+        cerr << "Could not write metrics to " << metricsPath << "\n";
+        return 1;
+    }
+    if (!tracePath.empty() && !TraceRecorder::global().write(tracePath)) {
+        cerr << "Could not write trace to " << tracePath << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// dtree export <model.bin | data.csv | -> <out.svg | out.png | -> [--delimiter C]
+//              [--font PATH] [--size PIXELS]
+// Renders the tree without a window: SVG is streamed to the file (or to stdout for "-"),
+// PNG is drawn offscreen (PNG only in builds with SFML, i.e. CPLHW1).
+inline int exportModel(int argc, char *argv[]) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " export <model.bin | data.csv | -> <out.svg | out.png | ->"
+             << " [--delimiter C] [--font PATH] [--size PIXELS]\n";
+        return 1;
+    }
+    ExportOptions options;
+    char delimiter = ',';
+    for (int i = 4; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--font") options.fontPath = argv[++i];
+        else if (flag == "--size") {
+            if (!parseNumber(flag, argv[++i], options.maxPixels)) return 1;
+            options.maxPixels = max(1u, options.maxPixels);
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    string out = argv[3];
+    auto write = [&](const TreeNode *root) {
+        if (out != "-") return TreeExport::write(root, out, options);
+        if (!root) {
+            cerr << "Nothing to export: the tree is empty\n";
+            return false;
+        }
+        TreeExport::writeSvg(TreeLayout(root), cout);
+        return static_cast<bool>(cout.flush());
+    };
+
+    if (string(argv[2]) != "-" && ModelFile::isModelFile(argv[2])) {
+        MappedModel model;
+        if (!model.open(argv[2])) return 1;
+        ModelTree tree(model);
+        return write(tree.getRoot()) ? 0 : 1;
+    }
+    ifstream file;
+    istream *in = openInput(argv[2], file);
+    if (!in) return 1;
+    DataSheet data(*in, delimiter);
+    DecisionTree tree(&data);
+    return write(tree.getRoot()) ? 0 : 1;
+}
+
+#ifdef DT_WITH_SFML
+// CPLHW1 view <model.bin | data.csv | -> [--delimiter C]
+// Opens the interactive window on a saved model, or on the tree trained from a dataset
+// once identical subtrees are merged, so shared subtrees show as they are stored.
+inline int viewModel(int argc, char *argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " view <model.bin | data.csv | -> [--delimiter C]\n";
+        return 1;
+    }
+    char delimiter = ',';
+    for (int i = 3; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    auto show = [](const TreeNode *root) {
+        if (!root) {
+            cerr << "Nothing to view: the tree is empty\n";
+            return 1;
+        }
+        visualizeTree(root);
+        return 0;
+    };
+    if (string(argv[2]) != "-" && ModelFile::isModelFile(argv[2])) {
+        MappedModel model;
+        if (!model.open(argv[2])) return 1;
+        ModelTree tree(model);
+        return show(tree.getRoot());
+    }
+    ifstream file;
+    istream *in = openInput(argv[2], file);
+    if (!in) return 1;
+    DataSheet data(*in, delimiter);
+    DecisionTree tree(&data);
+    return show(tree.getRoot());
+}
+#endif
+
+// dtree predict <model.bin> [data.csv | -] [--delimiter C] [--output PATH | -] [--batch ROWS]
+// Streams rows (stdin by default) through the model in batches and writes one predicted
+// label per row, "?" where the tree has no branch for a value. Memory is bounded by the
+// batch, so this works as a pipeline stage on inputs of any length.
+inline int predictRows(int argc, char *argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " predict <model.bin> [data.csv | -] [--delimiter C]"
+             << " [--output PATH | -] [--batch ROWS]\n";
+        return 1;
+    }
+    string inputPath = "-", outputPath = "-";
+    char delimiter = ',';
+    size_t batchRows = 4096;
+    int i = 3;
+    if (i < argc && argv[i][0] != '-') inputPath = argv[i++];
+    else if (i < argc && string(argv[i]) == "-") ++i;
+    for (; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--output") outputPath = argv[++i];
+        else if (flag == "--batch") {
+            if (!parseNumber(flag, argv[++i], batchRows)) return 1;
+            batchRows = max<size_t>(1, batchRows);
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    MappedModel model;
+    if (!model.open(argv[2])) return 1;
+    ifstream file;
+    istream *in = openInput(inputPath, file);
+    if (!in) return 1;
+    ofstream outFile;
+    if (outputPath != "-") {
+        outFile.open(outputPath, ios::binary | ios::trunc);
+        if (!outFile.is_open()) {
+            cerr << "Error opening " << outputPath << " for writing\n";
+            return 1;
+        }
+    }
+    ostream &out = outputPath == "-" ? cout : outFile;
+
+    ModelRowReader reader(*in, delimiter);
+    if (!reader.open(model)) return 1;
+    vector<uint32_t> predictions;
+    string buf;
+    while (reader.next(batchRows)) {
+        model.predictBatch(reader.rows(), predictions);
+        buf.clear();
+        for (uint32_t p : predictions) {
+            if (p == MappedModel::None) buf += '?';
+            else buf += model.label(p);
+            buf += '\n';
+        }
+        out.write(buf.data(), static_cast<streamsize>(buf.size()));
+    }
+    out.flush();
+    if (!out) {
+        cerr << "Error writing predictions\n";
+        return 1;
+    }
+    return 0;
+}
+
+// dtree eval <model.bin> [data.csv | -] [--delimiter C] [--batch ROWS]
+// Streams labelled rows through the model and prints accuracy and the confusion counts
+// (actual label, predicted label, rows) to stdout.
+inline int evaluateModel(int argc, char *argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " eval <model.bin> [data.csv | -] [--delimiter C] [--batch ROWS]\n";
+        return 1;
+    }
+    string inputPath = "-";
+    char delimiter = ',';
+    size_t batchRows = 4096;
+    int i = 3;
+    if (i < argc && argv[i][0] != '-') inputPath = argv[i++];
+    else if (i < argc && string(argv[i]) == "-") ++i;
+    for (; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--batch") {
+            if (!parseNumber(flag, argv[++i], batchRows)) return 1;
+            batchRows = max<size_t>(1, batchRows);
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    MappedModel model;
+    if (!model.open(argv[2])) return 1;
+    ifstream file;
+    istream *in = openInput(inputPath, file);
+    if (!in) return 1;
+    ModelRowReader reader(*in, delimiter);
+    if (!reader.open(model)) return 1;
+
+    uint64_t rows = 0, correct = 0, unknown = 0;
+    map<pair<string, string>, uint64_t> confusion;
+    vector<uint32_t> predictions;
+    while (reader.next(batchRows)) {
+        model.predictBatch(reader.rows(), predictions);
+        auto const &actual = reader.labels();
+        for (size_t r = 0; r < predictions.size(); ++r) {
+            string_view predicted = predictions[r] == MappedModel::None ? string_view("?") : model.label(predictions[r]);
+            unknown += predictions[r] == MappedModel::None;
+            correct += predicted == actual[r];
+            ++confusion[{string(actual[r]), string(predicted)}];
+        }
+        rows += predictions.size();
+    }
+
+    cout << "rows " << rows << "\n"
+         << "correct " << correct << "\n"
+         << "unknown " << unknown << "\n"
+         << "accuracy " << fixed << setprecision(4) << (rows ? double(correct) / double(rows) : 0.0) << "\n"
+         << "\nactual,predicted,rows\n";
+    for (auto const &kv : confusion)
+        cout << kv.first.first << "," << kv.first.second << "," << kv.second << "\n";
+    return 0;
+}
+
+// dtree bench <model.bin> <data.csv | -> [--delimiter C] [--batch ROWS] [--min-time SECONDS]
+//             [--profile HOLDOUT.csv]
+// Loads the rows once, then scores them in batches until min-time has passed and prints
+// the prediction throughput. With --profile the model is also laid out again from the
+// holdout's visit counts (as train --profile saves it) and timed the same way, so the
+// two layouts can be compared on one host.
+inline int benchModel(int argc, char *argv[]) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " bench <model.bin> <data.csv | -> [--delimiter C] [--batch ROWS]"
+             << " [--min-time SECONDS] [--profile HOLDOUT.csv]\n";
+        return 1;
+    }
+    char delimiter = ',';
+    size_t batchRows = 4096;
+    double minTime = 1.0;
+    string profilePath;
+    for (int i = 4; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--batch") {
+            if (!parseNumber(flag, argv[++i], batchRows)) return 1;
+            batchRows = max<size_t>(1, batchRows);
+        }
+        else if (flag == "--min-time") {
+            if (!parseNumber(flag, argv[++i], minTime)) return 1;
+            minTime = max(0.001, minTime);
+        }
+        else if (flag == "--profile") profilePath = argv[++i];
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    MappedModel model;
+    if (!model.open(argv[2])) return 1;
+    ifstream file;
+    istream *in = openInput(argv[3], file);
+    if (!in) return 1;
+    ModelRowReader reader(*in, delimiter);
+    if (!reader.open(model)) return 1;
+    // The reader's rows point into its line buffer, so keep owned copies here
+    vector<vector<string>> owned;
+    while (reader.next(batchRows))
+        for (auto const &row : reader.rows()) owned.emplace_back(row.begin(), row.end());
+    if (owned.empty()) {
+        cerr << "No rows to benchmark\n";
+        return 1;
+    }
+
+    auto run = [&](const MappedModel &scored, const char *layout) {
+        vector<uint32_t> predictions;
+        uint64_t count = 0;
+        auto start = chrono::steady_clock::now();
+        double elapsed = 0.0;
+        do {
+            for (size_t first = 0; first < owned.size(); first += batchRows) {
+                span<const vector<string>> batch(owned.data() + first, min(batchRows, owned.size() - first));
+                scored.predictBatch(batch, predictions);
+            }
+            count += owned.size();
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        } while (elapsed < minTime);
+
+        cout << layout << "rows " << owned.size() << ", batch " << batchRows << ", " << count << " predictions in "
+             << fixed << setprecision(3) << elapsed << " s: "
+             << setprecision(1) << elapsed * 1e9 / static_cast<double>(count) << " ns/row, "
+             << setprecision(0) << static_cast<double>(count) / elapsed << " rows/s\n";
+    };
+    if (profilePath.empty()) {
+        run(model, "");
+        return 0;
+    }
+
+    // The profiled layout is saved to a temporary file and mapped like the original
+    ifstream holdoutFile;
+    istream *holdoutIn = openInput(profilePath, holdoutFile);
+    if (!holdoutIn) return 1;
+    DataSheet holdout(*holdoutIn, delimiter);
+    FlatTree flat = model.toFlatTree();
+    flat.optimizeLayout(flat.profileVisits(holdout));
+    string profiledPath = (filesystem::temp_directory_path() / ("dtree-profiled-" + to_string(getpid()) + ".bin")).string();
+    MappedModel profiled;
+    bool saved = ModelFile::save(flat, profiledPath) && profiled.open(profiledPath);
+    remove(profiledPath.c_str());           // the mapping stays valid after the unlink
+    if (!saved) return 1;
+    run(model, "saved layout:    ");
+    run(profiled, "profiled layout: ");
+    return 0;
+}
+
+// dtree stream <model.bin> [data.csv | -] [--delimiter C] [--delta D] [--tie T] [--grace ROWS]
+//              [--memory-budget MB] [--checkpoint ROWS]
+// Online training with a Hoeffding tree (hoeffding_tree.h): rows are learned one at a
+// time from the input (stdin by default, which need never end) and model.bin is
+// rewritten every --checkpoint rows and at the end of input, so dtree_server can pick
+// it up with SIGHUP. Each checkpoint prints prequential accuracy (every row is predicted
+// before it is learned) and the tree size on stderr.
+inline int streamTrain(int argc, char *argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " stream <model.bin> [data.csv | -] [--delimiter C] [--delta D] [--tie T]"
+             << " [--grace ROWS] [--memory-budget MB] [--checkpoint ROWS]\n";
+        return 1;
+    }
+    string inputPath = "-";
+    char delimiter = ',';
+    HoeffdingOptions options;
+    uint64_t checkpointRows = 100000;
+    int i = 3;
+    if (i < argc && argv[i][0] != '-') inputPath = argv[i++];
+    else if (i < argc && string(argv[i]) == "-") ++i;
+    for (; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--delta") {
+            if (!parseNumber(flag, argv[++i], options.delta)) return 1;
+            options.delta = clamp(options.delta, 1e-300, 0.5);
+        }
+        else if (flag == "--tie") {
+            if (!parseNumber(flag, argv[++i], options.tieThreshold)) return 1;
+            options.tieThreshold = max(0.0, options.tieThreshold);
+        }
+        else if (flag == "--grace") {
+            if (!parseNumber(flag, argv[++i], options.gracePeriod)) return 1;
+            options.gracePeriod = max<uint32_t>(1, options.gracePeriod);
+        }
+        else if (flag == "--memory-budget") {
+            double megabytes = 0;
+            if (!parseNumber(flag, argv[++i], megabytes)) return 1;
+            options.memoryBudget = static_cast<size_t>(max(1.0, megabytes) * 1024 * 1024);
+        }
+        else if (flag == "--checkpoint") {
+            if (!parseNumber(flag, argv[++i], checkpointRows)) return 1;
+            checkpointRows = max<uint64_t>(1, checkpointRows);
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    ifstream file;
+    istream *in = openInput(inputPath, file);
+    if (!in) return 1;
+    string line;
+    if (!getline(*in, line)) {
+        cerr << "Input is empty, expected a header line\n";
+        return 1;
+    }
+    vector<string> headers;
+    DataSheet::splitDelimiter(line, headers, delimiter);
+    if (headers.size() < 2) {
+        cerr << "Need at least one attribute column and a label column\n";
+        return 1;
+    }
+
+    HoeffdingTree tree(headers, options);
+    uint64_t correct = 0, skipped = 0, sinceCheckpoint = 0;
+    auto checkpoint = [&] {
+        auto model = tree.snapshot();
+        if (!model || !model->saveModel(argv[2])) return false;
+        auto st = tree.stats();
+        char text[256];
+        snprintf(text, sizeof text,
+                 "[stream] %llu rows, prequential accuracy %.4f, %zu nodes (%zu leaves, %zu learning), %.1f MB statistics\n",
+                 static_cast<unsigned long long>(st.rows), st.rows ? double(correct) / double(st.rows) : 0.0,
+                 st.nodes, st.leaves, st.activeLeaves, double(st.statsBytes) / (1024.0 * 1024.0));
+        cerr << text;
+        return true;
+    };
+
+    vector<string_view> fields;
+    while (getline(*in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        splitFields(line, delimiter, fields);
+        if (fields.size() != headers.size()) {
+            ++skipped;
+            continue;
+        }
+        correct += tree.predict(fields) == fields.back();
+        tree.learn(fields);
+        if (++sinceCheckpoint == checkpointRows) {
+            sinceCheckpoint = 0;
+            if (!checkpoint()) return 1;
+        }
+    }
+    if (skipped) cerr << "Skipped " << skipped << " rows without " << headers.size() << " fields\n";
+    if (tree.stats().rows == 0) {
+        cerr << "No rows were learned, so no model was saved\n";
+        return 1;
+    }
+    if (sinceCheckpoint == 0) return 0;     // already saved
+    return checkpoint() ? 0 : 1;
+}
+
+// dtree update <state> <rows.csv | -> <model.bin> [--delimiter C] [--rebuild]
+// Append rows to the dataset kept in the state file (created on first use) and update
+// the tree instead of growing it again (incremental_training.h), then rewrite the state
+// and model.bin. The model is the one "dtree train" grows from all rows so far;
+// --rebuild regrows it from scratch, to check that or to compare timings.
+inline int updateModel(int argc, char *argv[]) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0] << " update <state> <rows.csv | -> <model.bin> [--delimiter C] [--rebuild]\n";
+        return 1;
+    }
+    string statePath = argv[2], inputPath = argv[3], modelPath = argv[4];
+    char delimiter = ',';
+    bool rebuild = false;
+    for (int i = 5; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--rebuild") rebuild = true;
+        else if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        else if (flag == "--delimiter") {
+            if (!parseDelimiter(argv[++i], delimiter)) return 1;
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    IncrementalTrainer trainer(delimiter);
+    if (filesystem::exists(statePath) && !trainer.load(statePath)) return 1;
+    ifstream file;
+    istream *in = openInput(inputPath, file);
+    if (!in || !trainer.append(*in)) return 1;
+    if (trainer.empty()) {
+        cerr << "No data rows yet, nothing to train\n";
+        return 1;
+    }
+    if (rebuild) trainer.rebuild();
+
+    auto const &st = trainer.lastUpdate();
+    cerr << "[update] " << trainer.rowCount() << " rows (" << st.newRows << " new): "
+         << st.nodesUpdated << " nodes updated, " << st.subtreesRebuilt << " subtrees regrown from "
+         << st.rowsRebuilt << " rows\n";
+    if (!trainer.save(statePath)) return 1;
+    return trainer.snapshot()->saveModel(modelPath) ? 0 : 1;
+}
+
+inline void printUsage(const char *program) {
+    cerr << "Usage: " << program << " <command> ...\n"
+         << "  train <data.csv | -> <model.bin> [--delimiter C] [--verbose] [--print-data] [--print-tree]\n"
+         << "        [--metrics-file PATH] [--trace PATH] [--memory-report] [--progress SECONDS]\n"
+         << "        [--external [--memory-budget MB] [--temp-dir DIR]] [--profile HOLDOUT.csv]"
+#ifdef DT_WITH_SFML
+         << " [--live]"
+#endif
+         << "\n"
+         << "  predict <model.bin> [data.csv | -] [--delimiter C] [--output PATH | -] [--batch ROWS]\n"
+         << "  eval <model.bin> [data.csv | -] [--delimiter C] [--batch ROWS]\n"
+         << "  export <model.bin | data.csv | -> <out.svg | out.png | -> [--delimiter C] [--font PATH]"
+         << " [--size PIXELS]\n"
+         << "  bench <model.bin> <data.csv | -> [--delimiter C] [--batch ROWS] [--min-time SECONDS]"
+         << " [--profile HOLDOUT.csv]\n"
+         << "  stream <model.bin> [data.csv | -] [--delimiter C] [--delta D] [--tie T] [--grace ROWS]\n"
+         << "         [--memory-budget MB] [--checkpoint ROWS]\n"
+         << "  update <state> <rows.csv | -> <model.bin> [--delimiter C] [--rebuild]\n";
+#ifdef DT_WITH_SFML
+    cerr << "  view <model.bin | data.csv | -> [--delimiter C]\n";
+#endif
+}
+
+// Run argv[1] as a subcommand; -1 when it is not one. Subcommands never prompt and
+// print the training narration only when asked (train --verbose).
+inline int runCommand(int argc, char *argv[]) {
+    using Command = int (*)(int, char*[]);
+    static const pair<string_view, Command> commands[] = {
+        {"train", trainModel}, {"predict", predictRows}, {"eval", evaluateModel},
+        {"export", exportModel}, {"bench", benchModel}, {"stream", streamTrain},
+        {"update", updateModel},
+#ifdef DT_WITH_SFML
+        {"view", viewModel},
+#endif
+    };
+    if (argc < 2) return -1;
+    for (auto const &[name, command] : commands) {
+        if (name != argv[1]) continue;
+        TrainingLog::global().out = nullptr;
+        return command(argc, argv);
+    }
+    return -1;
+}
@@ -0,0 +1,1599 @@
+// decision_tree.h
+//
+// Dataset loading, tree training, flat inference and model files. No GUI dependencies:
+// the viewer lives in tree_viewer.h and the exporters in tree_export.h.
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cmath>
+#include <algorithm>
+#include <cfloat> // For FLT_MAX
+#include <iomanip>
+#include <sstream>
+#include <cstdint>
+#include <queue>
+#include <string_view>
+#include <span>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <limits>
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "metrics.h"
+#include "alloc_tracker.h"
+#include "trace.h"
+#include "perf_counters.h"
+#include "progress.h"
+#include "training_feed.h"
+
+using namespace std;
+
+// Step-by-step training trace: entropies, gains and the chosen splits. The interactive
+// program prints it to cout; batch commands set out to nullptr, which also skips all of
+// the formatting, or point it at cerr to keep stdout free for pipeline output.
+class TrainingLog {
+public:
+    static TrainingLog& global() {
+        static TrainingLog instance;
+        return instance;
+    }
+
+    ostream *out = &cout;
+};
+
+inline void printIndent(ostream &out, int depth) {
+    for (int i = 0; i < depth; ++i) out << "  ";
+}
+// ————————————————————————————————————————————————————————————————————————————————
+// DataSheet: reads a CSV (comma-delimited by default) into a 2D vector<string> and computes
+// overall entropy.
+// ————————————————————————————————————————————————————————————————————————————————
+class DataSheet {
+public:
+    explicit DataSheet(istream &file, char delimiter = ',')
+        : dataFile{}, entropyOfDatas(0.0)
+    {
+        {
+            PhaseTimer timer(Metrics::Phase::Load);
+            AllocScope scope(AllocSubsystem::Loader);
+            readFile(file, delimiter);
+        }
+        entropyOfDatas = calculateEntropy();
+    }
+    double calculateEntropy() {
+        unordered_map<string,int> classCount;
+        int row = static_cast<int>(dataFile.size());
+        int col = static_cast<int>(dataFile[0].size());
+
+        for (int i = 1; i < row; ++i) {
+            const string &lab = dataFile[i][col - 1];
+            classCount[lab]++;
+        }
+        double ent = 0.0;
+        for (auto const &kv : classCount) {
+            double p = static_cast<double>(kv.second) / (row - 1);
+            ent += -p * log2(p);
+        }
+        return ent;
+    }
+    double calculateEntropy(const vector<string>& labels, int depth) {
+        unordered_map<string,int> freq;
+        for (auto& lab : labels) freq[lab]++;
+        double entropy = 0.0;
+        int n = labels.size();
+
+        for (auto& kv : freq) {
+            double p = double(kv.second) / n;
+            entropy -= p * log2(p);
+        }
+
+        if (ostream *log = TrainingLog::global().out) {
+            printIndent(*log, depth);
+            *log << "Entropy calc for ";
+            for (auto& kv : freq) *log << kv.first << ":" << kv.second << " ";
+            *log << "→ " << fixed << setprecision(3) << entropy << "\n";
+        }
+        return entropy;
+    }
+    void printData() const {
+        cout << "There are " << dataFile[0].size() << " attributes and "
+             << (dataFile.size() - 1) << " data rows.\n\n";
+
+        for (size_t j = 0; j < dataFile[0].size(); ++j) {
+            cout << dataFile[0][j] << (j + 1 == dataFile[0].size() ? "\n" : ", ");
+        }
+        for (size_t i = 1; i < dataFile.size(); ++i) {
+            for (size_t j = 0; j < dataFile[i].size(); ++j) {
+                cout << dataFile[i][j] << (j + 1 == dataFile[i].size() ? "\n" : ", ");
+            }
+        }
+        cout << "\n";
+    }
+
+    double calculateInformationGain(string_view attributeName) const {
+        int attributeIndex = -1;
+        int columnCount = static_cast<int>(dataFile[0].size());
+        int rowCount = static_cast<int>(dataFile.size());
+
+        for (int i = 0; i < columnCount - 1; ++i) {
+            if (dataFile[0][i] == attributeName) {
+                attributeIndex = i;
+                break;
+            }
+        }
+        if (attributeIndex < 0) {
+            cerr << "Attribute not found: " << attributeName << "\n";
+            return 0.0;
+        }
+
+        unordered_map<string, vector<vector<string>>> partitions;
+        for (int i = 1; i < rowCount; ++i) {
+            const string &key = dataFile[i][attributeIndex];
+            partitions[key].push_back(dataFile[i]);
+        }
+
+        double infoGain = entropyOfDatas;
+
+        for (auto const &kv : partitions) {
+            const auto &subset = kv.second;
+            unordered_map<string,int> labelCount;
+            for (auto const &row : subset) {
+                const string &lab = row[columnCount - 1];
+                labelCount[lab]++;
+            }
+            double subsetEntropy = 0.0;
+            for (auto const &lp : labelCount) {
+                double p = static_cast<double>(lp.second) / subset.size();
+                subsetEntropy += -p * log2(p);
+            }
+            infoGain -= (static_cast<double>(subset.size()) / (rowCount - 1)) * subsetEntropy;
+        }
+
+        return infoGain;
+    }
+
+    const vector<vector<string>>& getData() const {
+        return dataFile;
+    }
+
+    vector<string> getHeaders() const {
+        return dataFile.empty() ? vector<string>{} : dataFile[0];
+    }
+
+    double getEntropy() const {
+        return entropyOfDatas;
+    }
+
+    static void splitDelimiter(const string &input, vector<string> &output, char delimiter) {
+        output.clear();
+        size_t start = 0;
+        while (true) {
+            size_t pos = input.find(delimiter, start);
+            if (pos == string::npos) {
+                output.emplace_back(input.substr(start));
+                break;
+            }
+            output.emplace_back(input.substr(start, pos - start));
+            start = pos + 1;
+        }
+    }
+
+private:
+    vector<vector<string>> dataFile;
+    double entropyOfDatas;
+
+    void readFile(istream &file, char delimiter) {
+        string line;
+        vector<string> temp;
+        while (getline(file, line)) {
+            splitDelimiter(line, temp, delimiter);
+            dataFile.emplace_back(temp);
+        }
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// NodeArena: per-tree bump allocator for nodes, edge arrays and interned strings.
+// Only trivially destructible objects are placed here, so the whole tree is released
+// in one operation when the arena (and with it the DecisionTree) is destroyed.
+// ————————————————————————————————————————————————————————————————————————————————
+class NodeArena {
+public:
+    explicit NodeArena(size_t blockSize = 64 * 1024)
+        : blockSize(blockSize) {}
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t(align) - 1);
+        if (!cursor || p + bytes > reinterpret_cast<uintptr_t>(limit)) {
+            AllocScope scope(AllocSubsystem::TreeNodes);
+            size_t size = max(blockSize, bytes + align);
+            blocks.push_back(make_unique_for_overwrite<unsigned char[]>(size));
+            cursor = blocks.back().get();
+            limit = cursor + size;
+            reserved += size;
+            p = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t(align) - 1);
+        }
+        cursor = reinterpret_cast<unsigned char*>(p + bytes);
+        used += bytes;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        static_assert(is_trivially_destructible_v<T>, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    T* makeArray(size_t count) {
+        static_assert(is_trivially_destructible_v<T>, "arena objects are never destroyed");
+        if (count == 0) return nullptr;
+        T *arr = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; ++i) new (arr + i) T();
+        return arr;
+    }
+
+    // Copy a string into the arena once; equal strings share storage
+    string_view intern(string_view str) {
+        if (str.empty()) return {};
+        auto it = interned.find(str);
+        if (it != interned.end()) return *it;
+        char *mem = static_cast<char*>(allocate(str.size(), 1));
+        memcpy(mem, str.data(), str.size());
+        stringBytes += str.size();
+        AllocScope scope(AllocSubsystem::Dictionary);
+        return *interned.emplace(mem, str.size()).first;
+    }
+
+    size_t bytesReserved() const {
+        return reserved;
+    }
+
+    // Bytes handed out, excluding alignment padding and the unused tail of each block
+    size_t bytesUsed() const {
+        return used;
+    }
+
+    size_t internedBytes() const {
+        return stringBytes;
+    }
+
+    // Approximate heap footprint of the intern index (buckets plus one node per string)
+    size_t internIndexBytes() const {
+        return interned.bucket_count() * sizeof(void*)
+             + interned.size() * (sizeof(string_view) + sizeof(void*) + sizeof(size_t));
+    }
+
+private:
+    size_t blockSize;
+    vector<unique_ptr<unsigned char[]>> blocks;
+    unsigned char *cursor = nullptr;
+    unsigned char *limit = nullptr;
+    size_t reserved = 0;
+    size_t used = 0;
+    size_t stringBytes = 0;
+    unordered_set<string_view> interned;
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// TreeNode: each node holds either an attribute (internal node) or a label (leaf).
+// For each child we also store the edge value. Leaves are marked explicitly, since a
+// label read from an empty CSV cell is the empty string.
+// Nodes, their edge arrays and strings all live in the owning tree's NodeArena.
+// ————————————————————————————————————————————————————————————————————————————————
+struct TreeNode;
+
+struct TreeEdge {
+    string_view value;
+    TreeNode *child = nullptr;
+};
+
+// Constructor argument that makes a TreeNode a leaf predicting `label`
+struct LeafLabel {
+    string_view label;
+};
+
+struct TreeNode {
+    string_view attribute;          // if internal node
+    string_view label;              // if leaf; may be empty
+    TreeEdge *children = nullptr;   // sorted by value
+    uint32_t childCount = 0;
+    bool leaf = false;
+
+    explicit TreeNode(string_view attr)
+        : attribute(attr) {}
+    explicit TreeNode(LeafLabel lab)
+        : label(lab.label), leaf(true) {}
+
+    span<TreeEdge> edges() const {
+        return {children, childCount};
+    }
+
+    TreeNode* child(string_view value) const {
+        auto e = edges();
+        auto it = lower_bound(e.begin(), e.end(), value,
+                              [](const TreeEdge &edge, string_view v) { return edge.value < v; });
+        return (it != e.end() && it->value == value) ? it->child : nullptr;
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// FlatTree: the tree (or DAG) packed into contiguous node and edge arrays for inference.
+// Attributes are the feature columns in DataSheet header order, so a data row can be
+// scored directly; edge values are codes into a sorted per-attribute dictionary.
+// ————————————————————————————————————————————————————————————————————————————————
+struct FlatNode {
+    uint32_t attribute;   // column in FlatTree::attributes, or FlatTree::None for a leaf
+    uint32_t label;       // index into FlatTree::labels (leaves only)
+    uint32_t firstEdge;   // this node's edges are edges[firstEdge, firstEdge + edgeCount)
+    uint32_t edgeCount;
+};
+
+struct FlatEdge {
+    uint32_t value;       // code in values[attribute]
+    uint32_t child;       // index into FlatTree::nodes
+};
+
+// Shared traversal for FlatTree and MappedModel: both expose node(i), edge(i) and
+// valueCode(attr, value). Returns a label index, or UINT32_MAX when the row falls off.
+template <class Model, class Row>
+uint32_t walkFlat(const Model &model, const Row &row, vector<uint64_t> *visits = nullptr) {
+    constexpr uint32_t None = UINT32_MAX;
+    if (model.nodeCount() == 0) return None;
+    uint32_t idx = 0;
+    while (true) {
+        const FlatNode node = model.node(idx);
+        if (visits) ++(*visits)[idx];
+        if (node.attribute == None) return node.label;
+        if (node.attribute >= row.size()) return None;
+        uint32_t code = model.valueCode(node.attribute, row[node.attribute]);
+        if (code == None) return None;
+        uint32_t next = None;
+        for (uint32_t e = node.firstEdge; e < node.firstEdge + node.edgeCount; ++e) {
+            const FlatEdge edge = model.edge(e);
+            if (edge.value == code) { next = edge.child; break; }
+        }
+        if (next == None) return None;
+        idx = next;
+    }
+}
+
+struct FlatTree {
+    static constexpr uint32_t None = UINT32_MAX;
+
+    vector<string> attributes;
+    vector<vector<string>> values;   // sorted dictionary per attribute
+    vector<string> labels;
+    vector<FlatNode> nodes;          // nodes[0] is the root
+    vector<FlatEdge> edges;
+
+    bool empty() const {
+        return nodes.empty();
+    }
+
+    size_t nodeCount() const { return nodes.size(); }
+    const FlatNode& node(uint32_t i) const { return nodes[i]; }
+    const FlatEdge& edge(uint32_t i) const { return edges[i]; }
+
+    uint32_t valueCode(uint32_t attr, string_view value) const {
+        const auto &dict = values[attr];
+        auto it = lower_bound(dict.begin(), dict.end(), value,
+                              [](const string &a, string_view b) { return a < b; });
+        return (it != dict.end() && *it == value) ? static_cast<uint32_t>(it - dict.begin()) : None;
+    }
+
+    // Score one row whose columns follow `attributes`; returns a label index or None.
+    // When visits is given, every node on the path has its counter incremented.
+    uint32_t predictRow(const vector<string> &row, vector<uint64_t> *visits = nullptr) const {
+        return walkFlat(*this, row, visits);
+    }
+
+    // Score a representative sample and count how often each flat node is visited.
+    // Columns of the holdout are matched to the training attributes by header name.
+    vector<uint64_t> profileVisits(const DataSheet &holdout) const {
+        vector<uint64_t> visits(nodes.size(), 0);
+        const auto &data = holdout.getData();
+        if (data.empty() || empty()) return visits;
+
+        vector<int> source(attributes.size(), -1);
+        for (size_t i = 0; i < attributes.size(); ++i) {
+            auto it = find(data[0].begin(), data[0].end(), attributes[i]);
+            if (it != data[0].end()) source[i] = static_cast<int>(it - data[0].begin());
+        }
+
+        vector<string> row(attributes.size());
+        for (size_t r = 1; r < data.size(); ++r) {
+            for (size_t i = 0; i < source.size(); ++i) {
+                bool present = source[i] >= 0 && static_cast<size_t>(source[i]) < data[r].size();
+                row[i] = present ? data[r][source[i]] : string();
+            }
+            predictRow(row, &visits);
+        }
+        return visits;
+    }
+
+    // Profile-guided layout: repeatedly take the hottest unplaced node and lay out its
+    // chain of hottest children contiguously, so each node's hottest child sits right
+    // after it and the hottest root-to-leaf paths occupy the first cache lines. Edges
+    // are emitted in node order, hottest first, which also shortens the edge scan.
+    void optimizeLayout(const vector<uint64_t> &visits) {
+        if (empty() || visits.size() != nodes.size()) return;
+
+        vector<uint32_t> newIndex(nodes.size(), None);
+        vector<uint32_t> order;
+        order.reserve(nodes.size());
+        auto hotterChild = [&](const FlatEdge &a, const FlatEdge &b) {
+            return visits[a.child] != visits[b.child] ? visits[a.child] > visits[b.child]
+                                                      : a.value < b.value;
+        };
+
+        priority_queue<pair<uint64_t, uint32_t>> heads;
+        heads.push({visits[0], 0});
+        vector<FlatEdge> kids;
+        while (!heads.empty()) {
+            uint32_t cur = heads.top().second;
+            heads.pop();
+            while (cur != None && newIndex[cur] == None) {
+                newIndex[cur] = static_cast<uint32_t>(order.size());
+                order.push_back(cur);
+                const FlatNode &node = nodes[cur];
+                kids.assign(edges.begin() + node.firstEdge,
+                            edges.begin() + node.firstEdge + node.edgeCount);
+                sort(kids.begin(), kids.end(), hotterChild);
+                uint32_t next = None;
+                for (auto const &e : kids) {
+                    if (newIndex[e.child] != None) continue;
+                    if (next == None) next = e.child;
+                    else heads.push({visits[e.child], e.child});
+                }
+                cur = next;
+            }
+        }
+
+        vector<FlatNode> laidNodes;
+        vector<FlatEdge> laidEdges;
+        laidNodes.reserve(order.size());
+        laidEdges.reserve(edges.size());
+        for (uint32_t old : order) {
+            FlatNode node = nodes[old];
+            kids.assign(edges.begin() + node.firstEdge,
+                        edges.begin() + node.firstEdge + node.edgeCount);
+            sort(kids.begin(), kids.end(), hotterChild);
+            node.firstEdge = static_cast<uint32_t>(laidEdges.size());
+            for (auto e : kids) {
+                e.child = newIndex[e.child];
+                laidEdges.push_back(e);
+            }
+            laidNodes.push_back(node);
+        }
+        nodes = std::move(laidNodes);
+        edges = std::move(laidEdges);
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// Binary model file: a FlatTree with its dictionaries, laid out so it can be used
+// straight from an mmap. Every integer is little-endian and every section 8-byte aligned.
+//
+//   header     64 bytes, see ModelFile::Field
+//   strings    u32 pairs (offset, length) into the blob: attributes, labels, then each
+//              attribute's sorted value dictionary back to back
+//   dictStart  u32[attributeCount + 1], first value string of each attribute
+//   nodes      u32[4] per node (attribute, label, firstEdge, edgeCount), root first
+//   edges      u32[2] per edge (value code, child index)
+//   blob       raw string bytes
+// ————————————————————————————————————————————————————————————————————————————————
+namespace ModelFile {
+    constexpr char Magic[8] = {'D', 'T', 'M', 'O', 'D', 'E', 'L', '\0'};
+    constexpr uint32_t Version = 1;
+    constexpr size_t HeaderSize = 64;
+
+    // Byte offsets of the header fields after the magic
+    enum Field : size_t {
+        VersionField    = 8,   // u32
+        AttributeCount  = 12,  // u32
+        LabelCount      = 16,  // u32
+        ValueCount      = 20,  // u32
+        NodeCount       = 24,  // u32
+        EdgeCount       = 28,  // u32
+        StringsOffset   = 32,  // u32
+        DictOffset      = 36,  // u32
+        NodesOffset     = 40,  // u64
+        EdgesOffset     = 48,  // u64
+        BlobOffset      = 56   // u64
+    };
+
+    // Assembled byte by byte so the format is the same on every host; compilers turn
+    // these into single loads and stores on little-endian machines.
+    inline uint32_t load32(const unsigned char *p) {
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+    inline uint64_t load64(const unsigned char *p) {
+        return uint64_t(load32(p)) | uint64_t(load32(p + 4)) << 32;
+    }
+    inline void store32(vector<unsigned char> &out, size_t at, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out[at + i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+    inline void store64(vector<unsigned char> &out, size_t at, uint64_t v) {
+        store32(out, at, static_cast<uint32_t>(v));
+        store32(out, at + 4, static_cast<uint32_t>(v >> 32));
+    }
+    inline size_t align8(size_t n) {
+        return (n + 7) & ~size_t(7);
+    }
+
+    // True when the file starts with the model magic, so callers can tell models from datasets
+    inline bool isModelFile(const string &path) {
+        char magic[sizeof Magic] = {};
+        ifstream file(path, ios::binary);
+        return file.read(magic, sizeof magic) && memcmp(magic, Magic, sizeof Magic) == 0;
+    }
+
+    inline bool save(const FlatTree &tree, const string &path) {
+        vector<const string*> strings;
+        for (auto const &a : tree.attributes) strings.push_back(&a);
+        for (auto const &l : tree.labels) strings.push_back(&l);
+        vector<uint32_t> dictStart;
+        uint32_t valueCount = 0;
+        for (auto const &dict : tree.values) {
+            dictStart.push_back(valueCount);
+            for (auto const &v : dict) strings.push_back(&v);
+            valueCount += static_cast<uint32_t>(dict.size());
+        }
+        dictStart.push_back(valueCount);
+
+        size_t stringsOff = HeaderSize;
+        size_t dictOff = align8(stringsOff + strings.size() * 8);
+        size_t nodesOff = align8(dictOff + dictStart.size() * 4);
+        size_t edgesOff = nodesOff + tree.nodes.size() * 16;
+        size_t blobOff = align8(edgesOff + tree.edges.size() * 8);
+        size_t blobSize = 0;
+        for (auto const *str : strings) blobSize += str->size();
+
+        vector<unsigned char> out(align8(blobOff + blobSize), 0);
+        memcpy(out.data(), Magic, sizeof Magic);
+        store32(out, VersionField, Version);
+        store32(out, AttributeCount, static_cast<uint32_t>(tree.attributes.size()));
+        store32(out, LabelCount, static_cast<uint32_t>(tree.labels.size()));
+        store32(out, ValueCount, valueCount);
+        store32(out, NodeCount, static_cast<uint32_t>(tree.nodes.size()));
+        store32(out, EdgeCount, static_cast<uint32_t>(tree.edges.size()));
+        store32(out, StringsOffset, static_cast<uint32_t>(stringsOff));
+        store32(out, DictOffset, static_cast<uint32_t>(dictOff));
+        store64(out, NodesOffset, nodesOff);
+        store64(out, EdgesOffset, edgesOff);
+        store64(out, BlobOffset, blobOff);
+
+        size_t cursor = 0;
+        for (size_t i = 0; i < strings.size(); ++i) {
+            store32(out, stringsOff + i * 8, static_cast<uint32_t>(cursor));
+            store32(out, stringsOff + i * 8 + 4, static_cast<uint32_t>(strings[i]->size()));
+            memcpy(out.data() + blobOff + cursor, strings[i]->data(), strings[i]->size());
+            cursor += strings[i]->size();
+        }
+        for (size_t i = 0; i < dictStart.size(); ++i) store32(out, dictOff + i * 4, dictStart[i]);
+        for (size_t i = 0; i < tree.nodes.size(); ++i) {
+            const FlatNode &n = tree.nodes[i];
+            store32(out, nodesOff + i * 16, n.attribute);
+            store32(out, nodesOff + i * 16 + 4, n.label);
+            store32(out, nodesOff + i * 16 + 8, n.firstEdge);
+            store32(out, nodesOff + i * 16 + 12, n.edgeCount);
+        }
+        for (size_t i = 0; i < tree.edges.size(); ++i) {
+            store32(out, edgesOff + i * 8, tree.edges[i].value);
+            store32(out, edgesOff + i * 8 + 4, tree.edges[i].child);
+        }
+
+        // Write aside and rename over, so a server mapping the old file never sees a torn one
+        string tmpPath = path + ".tmp";
+        ofstream file(tmpPath, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error opening model file for writing: " << tmpPath << "\n";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(out.data()), static_cast<streamsize>(out.size()));
+        file.close();
+        if (!file || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            cerr << "Error writing model file: " << path << "\n";
+            remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+// ————————————————————————————————————————————————————————————————————————————————
+// MappedModel: a read-only model served directly from a shared, page-cached mmap of a
+// ModelFile. Opening only validates the header; nothing is parsed or copied.
+// ————————————————————————————————————————————————————————————————————————————————
+class MappedModel {
+public:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    MappedModel() = default;
+    MappedModel(const MappedModel&) = delete;
+    MappedModel& operator=(const MappedModel&) = delete;
+    ~MappedModel() {
+        close();
+    }
+
+    bool open(const string &path) {
+        PhaseTimer timer(Metrics::Phase::LoadModel);
+        AllocScope scope(AllocSubsystem::Loader);
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cerr << "Error opening model file: " << path << "\n";
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < ModelFile::HeaderSize) {
+            cerr << "Model file too small: " << path << "\n";
+            ::close(fd);
+            return false;
+        }
+        void *mem = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED) {
+            cerr << "Could not map model file: " << path << "\n";
+            return false;
+        }
+        base = static_cast<const unsigned char*>(mem);
+        size = static_cast<size_t>(st.st_size);
+        if (!validate()) {
+            cerr << "Invalid or unsupported model file: " << path << "\n";
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<unsigned char*>(base), size);
+        base = nullptr;
+        size = 0;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    size_t attributeCount() const { return attributes; }
+    size_t labelCount() const { return labels; }
+    size_t nodeCount() const { return nodes; }
+    size_t edgeCount() const { return edges; }
+
+    string_view attribute(uint32_t i) const { return str(i); }
+    string_view label(uint32_t i) const { return str(attributes + i); }
+    string_view value(uint32_t attr, uint32_t code) const { return str(attributes + labels + dictStart(attr) + code); }
+
+    FlatNode node(uint32_t i) const {
+        const unsigned char *p = base + nodesOff + size_t(i) * 16;
+        return {ModelFile::load32(p), ModelFile::load32(p + 4), ModelFile::load32(p + 8), ModelFile::load32(p + 12)};
+    }
+    FlatEdge edge(uint32_t i) const {
+        const unsigned char *p = base + edgesOff + size_t(i) * 8;
+        return {ModelFile::load32(p), ModelFile::load32(p + 4)};
+    }
+
+    // Binary search in the attribute's sorted dictionary
+    uint32_t valueCode(uint32_t attr, string_view value) const {
+        uint32_t lo = dictStart(attr), hi = dictStart(attr + 1), first = lo;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (str(attributes + labels + mid) < value) lo = mid + 1;
+            else hi = mid;
+        }
+        return (lo < dictStart(attr + 1) && str(attributes + labels + lo) == value) ? lo - first : None;
+    }
+
+    template <class Row>
+    uint32_t predictRow(const Row &row) const {
+        return walkFlat(*this, row);
+    }
+
+    // Batch predictor: out[i] is the label index for rows[i], or None
+    template <class Rows>
+    void predictBatch(const Rows &rows, vector<uint32_t> &out) const {
+        PerfScope counters(PerfCounters::Predict);
+        uint64_t start = metricsNow();
+        out.resize(rows.size());
+        uint64_t unknown = 0;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            out[i] = walkFlat(*this, rows[i]);
+            unknown += out[i] == None;
+        }
+        Metrics::global().batchLatency.record(metricsNow() - start);
+        Metrics::global().countRows(rows.size(), unknown);
+    }
+
+    // Copy the model into a FlatTree, e.g. to lay it out again and save the result
+    FlatTree toFlatTree() const {
+        FlatTree tree;
+        for (uint32_t a = 0; a < attributes; ++a) {
+            tree.attributes.emplace_back(attribute(a));
+            auto &dict = tree.values.emplace_back();
+            for (uint32_t v = 0; v < dictStart(a + 1) - dictStart(a); ++v) dict.emplace_back(value(a, v));
+        }
+        for (uint32_t l = 0; l < labels; ++l) tree.labels.emplace_back(label(l));
+        for (uint32_t i = 0; i < nodes; ++i) tree.nodes.push_back(node(i));
+        for (uint32_t i = 0; i < edges; ++i) tree.edges.push_back(edge(i));
+        return tree;
+    }
+
+private:
+    const unsigned char *base = nullptr;
+    size_t size = 0;
+    uint32_t attributes = 0, labels = 0, values = 0, nodes = 0, edges = 0;
+    size_t stringsOff = 0, dictOff = 0, nodesOff = 0, edgesOff = 0, blobOff = 0;
+
+    string_view str(uint32_t i) const {
+        const unsigned char *p = base + stringsOff + size_t(i) * 8;
+        return {reinterpret_cast<const char*>(base + blobOff + ModelFile::load32(p)), ModelFile::load32(p + 4)};
+    }
+    uint32_t dictStart(uint32_t attr) const {
+        return ModelFile::load32(base + dictOff + size_t(attr) * 4);
+    }
+
+    // Bounds-check the sections once so lookups can stay unchecked, and check that the
+    // nodes form a DAG so walks from the root always end
+    bool validate() {
+        using namespace ModelFile;
+        if (memcmp(base, Magic, sizeof Magic) != 0 || load32(base + VersionField) != Version) return false;
+        attributes = load32(base + AttributeCount);
+        labels = load32(base + LabelCount);
+        values = load32(base + ValueCount);
+        nodes = load32(base + NodeCount);
+        edges = load32(base + EdgeCount);
+        stringsOff = load32(base + StringsOffset);
+        dictOff = load32(base + DictOffset);
+        nodesOff = load64(base + NodesOffset);
+        edgesOff = load64(base + EdgesOffset);
+        blobOff = load64(base + BlobOffset);
+
+        size_t stringCount = size_t(attributes) + labels + values;
+        auto fits = [&](size_t off, size_t bytes) { return off <= size && bytes <= size - off; };
+        if (!fits(stringsOff, stringCount * 8) || !fits(dictOff, (size_t(attributes) + 1) * 4) ||
+            !fits(nodesOff, size_t(nodes) * 16) || !fits(edgesOff, size_t(edges) * 8) || !fits(blobOff, 0))
+            return false;
+        for (uint32_t i = 0; i < stringCount; ++i) {
+            const unsigned char *p = base + stringsOff + size_t(i) * 8;
+            if (!fits(blobOff + load32(p), load32(p + 4))) return false;
+        }
+        for (uint32_t a = 0; a < attributes; ++a) {
+            if (dictStart(a) > dictStart(a + 1) || dictStart(a + 1) > values) return false;
+        }
+        if (nodes == 0) return false;
+        vector<uint32_t> parents(nodes, 0);
+        for (uint32_t i = 0; i < nodes; ++i) {
+            FlatNode n = node(i);
+            if (n.attribute == None) {
+                if (n.label >= labels) return false;
+                continue;
+            }
+            if (n.attribute >= attributes || size_t(n.firstEdge) + n.edgeCount > edges) return false;
+            uint32_t dictSize = dictStart(n.attribute + 1) - dictStart(n.attribute);
+            for (uint32_t e = n.firstEdge; e < n.firstEdge + n.edgeCount; ++e) {
+                FlatEdge fe = edge(e);
+                if (fe.value >= dictSize || fe.child >= nodes) return false;
+                ++parents[fe.child];
+            }
+        }
+
+        // Shared (DAG) nodes can sit before some of their parents in pre-order and in a
+        // profiled layout, so index order proves nothing: peel off parentless nodes
+        // instead, and any node left over lies on a cycle
+        vector<uint32_t> ready;
+        for (uint32_t i = 0; i < nodes; ++i)
+            if (parents[i] == 0) ready.push_back(i);
+        uint32_t peeled = 0;
+        while (!ready.empty()) {
+            FlatNode n = node(ready.back());
+            ready.pop_back();
+            ++peeled;
+            if (n.attribute == None) continue;
+            for (uint32_t e = n.firstEdge; e < n.firstEdge + n.edgeCount; ++e)
+                if (--parents[edge(e).child] == 0) ready.push_back(edge(e).child);
+        }
+        return peeled == nodes;
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// ModelTree: TreeNodes rebuilt from a mapped model, so the layout, viewer and exporters
+// work on saved models as well as freshly trained trees. Shared nodes stay shared and
+// strings point into the mapping, which must outlive the ModelTree.
+// ————————————————————————————————————————————————————————————————————————————————
+class ModelTree {
+public:
+    explicit ModelTree(const MappedModel &model) {
+        auto count = static_cast<uint32_t>(model.nodeCount());
+        if (count == 0) return;
+        vector<TreeNode*> built(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            FlatNode f = model.node(i);
+            built[i] = f.attribute == MappedModel::None
+                ? arena.make<TreeNode>(LeafLabel{model.label(f.label)})
+                : arena.make<TreeNode>(model.attribute(f.attribute));
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            FlatNode f = model.node(i);
+            if (f.attribute == MappedModel::None || f.edgeCount == 0) continue;
+            TreeEdge *edges = arena.makeArray<TreeEdge>(f.edgeCount);
+            for (uint32_t k = 0; k < f.edgeCount; ++k) {
+                FlatEdge e = model.edge(f.firstEdge + k);
+                edges[k] = {model.value(f.attribute, e.value), built[e.child]};
+            }
+            built[i]->children = edges;
+            built[i]->childCount = f.edgeCount;
+        }
+        root = built[0];
+    }
+
+    ModelTree(const ModelTree&) = delete;
+    ModelTree& operator=(const ModelTree&) = delete;
+
+    const TreeNode* getRoot() const {
+        return root;
+    }
+
+private:
+    NodeArena arena;
+    TreeNode *root = nullptr;
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// DecisionTree: builds recursively on subsets, prints text, and predicts.
+// ————————————————————————————————————————————————————————————————————————————————
+class DecisionTree {
+public:
+    // Gains closer than this are a tie, won by the earlier attribute. Entropy sums depend
+    // on the order classes are visited in, so equal gains can differ in the last bits.
+    static constexpr double GainTolerance = 1e-12;
+
+    explicit DecisionTree(DataSheet *data)
+        : dataFile(data)
+    {
+        headers = dataFile->getHeaders();
+        {
+            PhaseTimer timer(Metrics::Phase::Train);
+            AllocScope scope(AllocSubsystem::TrainingScratch);
+            TrainingProgress::global().begin(dataFile->getData().size() - 1);
+            root = buildTree(dataFile->getData(), headers);
+            TrainingProgress::global().finish();
+        }
+        compile();
+    }
+
+    // Adopt a tree grown outside this class (see ExternalTrainer): grow(arena) builds it in
+    // this tree's arena and returns the root; headers are the data columns, label last
+    template <class Grow>
+    DecisionTree(vector<string> columns, Grow &&grow)
+        : headers(std::move(columns))
+    {
+        {
+            PhaseTimer timer(Metrics::Phase::Train);
+            AllocScope scope(AllocSubsystem::TrainingScratch);
+            root = grow(arena);
+        }
+        compile();
+    }
+
+    // Nodes are owned by the arena and released with it in one operation
+    DecisionTree(const DecisionTree&) = delete;
+    DecisionTree& operator=(const DecisionTree&) = delete;
+    ~DecisionTree() = default;
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // After training: share identical subtrees, then build the lookup table and FlatTree.
+    void compile() {
+        {
+            PhaseTimer timer(Metrics::Phase::Compile);
+            {
+                AllocScope scope(AllocSubsystem::TrainingScratch);
+                mergeIdenticalSubtrees();
+            }
+            AllocScope scope(AllocSubsystem::Predictor);
+            compileLookupTable();
+        }
+        {
+            PhaseTimer timer(Metrics::Phase::Encode);
+            AllocScope scope(AllocSubsystem::Dictionary);
+            flatten();
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // Pack the (possibly shared) nodes into a FlatTree in pre-order, edges in value order.
+    void flatten() {
+        flat = FlatTree{};
+        if (!root) return;
+
+        for (size_t i = 0; i + 1 < headers.size(); ++i) flat.attributes.push_back(headers[i]);
+        flat.values.resize(flat.attributes.size());
+        unordered_map<string, uint32_t> column;
+        for (size_t i = 0; i < flat.attributes.size(); ++i)
+            column.emplace(flat.attributes[i], static_cast<uint32_t>(i));
+
+        // Number nodes in pre-order and gather dictionaries
+        unordered_map<const TreeNode*, uint32_t> index;
+        vector<const TreeNode*> order;
+        vector<const TreeNode*> stack{root};
+        while (!stack.empty()) {
+            const TreeNode *node = stack.back();
+            stack.pop_back();
+            if (!index.emplace(node, static_cast<uint32_t>(order.size())).second) continue;
+            order.push_back(node);
+            if (node->leaf) {
+                flat.labels.emplace_back(node->label);
+                continue;
+            }
+            auto &dict = flat.values[column.at(string(node->attribute))];
+            auto kids = node->edges();
+            for (auto it = kids.rbegin(); it != kids.rend(); ++it) {
+                dict.emplace_back(it->value);
+                stack.push_back(it->child);
+            }
+        }
+        sort(flat.labels.begin(), flat.labels.end());
+        flat.labels.erase(unique(flat.labels.begin(), flat.labels.end()), flat.labels.end());
+        for (auto &dict : flat.values) {
+            sort(dict.begin(), dict.end());
+            dict.erase(unique(dict.begin(), dict.end()), dict.end());
+        }
+
+        for (const TreeNode *node : order) {
+            FlatNode fn{FlatTree::None, FlatTree::None, static_cast<uint32_t>(flat.edges.size()), 0};
+            if (node->leaf) {
+                fn.label = static_cast<uint32_t>(lower_bound(flat.labels.begin(), flat.labels.end(), node->label)
+                                                 - flat.labels.begin());
+            } else {
+                fn.attribute = column.at(string(node->attribute));
+                for (auto const &e : node->edges())
+                    flat.edges.push_back({flat.valueCode(fn.attribute, e.value), index.at(e.child)});
+                fn.edgeCount = node->childCount;
+            }
+            flat.nodes.push_back(fn);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // Batch predictor over rows in training header order (a trailing label column is ignored).
+    vector<string> predictBatch(const vector<vector<string>> &rows) const {
+        AllocScope scope(AllocSubsystem::Predictor);
+        PerfScope counters(PerfCounters::Predict);
+        uint64_t start = metricsNow();
+        vector<string> out;
+        out.reserve(rows.size());
+        uint64_t unknown = 0;
+        for (auto const &row : rows) {
+            uint32_t lab = flat.predictRow(row);
+            unknown += lab == FlatTree::None;
+            out.push_back(lab == FlatTree::None ? "Unknown" : flat.labels[lab]);
+        }
+        Metrics::global().batchLatency.record(metricsNow() - start);
+        Metrics::global().countRows(rows.size(), unknown);
+        return out;
+    }
+
+    // Profile-guided layout of the flat tree (see FlatTree::optimizeLayout): visit counts
+    // from scoring a representative holdout, then the relayout they drive
+    vector<uint64_t> profileVisits(const DataSheet &holdout) const {
+        return flat.profileVisits(holdout);
+    }
+
+    void optimizeLayout(const vector<uint64_t> &visits) {
+        flat.optimizeLayout(visits);
+    }
+
+    const FlatTree& getFlatTree() const {
+        return flat;
+    }
+
+    const TreeNode* getRoot() const {
+        return root;
+    }
+
+    // Write the flat tree and its dictionaries as a ModelFile for MappedModel to serve
+    bool saveModel(const string &path) const {
+        return ModelFile::save(flat, path);
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // Hash-cons structurally identical subtrees so the tree becomes a decision DAG.
+    // Children are interned bottom-up, so two nodes are merged when they test the same
+    // attribute (or hold the same label) and lead to the same canonical child per value.
+    // Returns the number of distinct nodes left.
+    size_t mergeIdenticalSubtrees() {
+        unordered_map<string, TreeNode*> unique;
+        unordered_map<TreeNode*, TreeNode*> canonical;
+        unordered_map<TreeNode*, size_t> ids;
+        root = internSubtree(root, unique, canonical, ids);
+        return ids.size();
+    }
+
+    // Number of distinct nodes reachable from the root (shared nodes count once).
+    size_t nodeCount() const {
+        unordered_set<const TreeNode*> seen;
+        vector<const TreeNode*> stack;
+        if (root) stack.push_back(root);
+        while (!stack.empty()) {
+            const TreeNode *node = stack.back();
+            stack.pop_back();
+            if (!seen.insert(node).second) continue;
+            for (auto const &e : node->edges()) stack.push_back(e.child);
+        }
+        return seen.size();
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // Memory held by the trained model, split by structure. Node and edge bytes count
+    // the reachable (deduplicated) tree; arenaUnreachable is what DAG merging orphaned
+    // plus alignment padding, and arenaSlack the unused tail of the arena blocks.
+    struct MemoryUsage {
+        size_t nodes = 0, nodeBytes = 0;
+        size_t edges = 0, edgeBytes = 0;
+        size_t stringBytes = 0;         // interned attribute, value and label text
+        size_t internIndexBytes = 0;
+        size_t arenaUnreachable = 0;
+        size_t arenaSlack = 0;
+        size_t flatBytes = 0;           // FlatTree arrays and dictionaries
+        size_t lookupBytes = 0;         // compiled lookup table (approximate for its maps)
+    };
+
+    MemoryUsage memoryUsage() const {
+        MemoryUsage m;
+        unordered_set<const TreeNode*> seen;
+        vector<const TreeNode*> stack;
+        if (root) stack.push_back(root);
+        while (!stack.empty()) {
+            const TreeNode *node = stack.back();
+            stack.pop_back();
+            if (!seen.insert(node).second) continue;
+            m.edges += node->childCount;
+            for (auto const &e : node->edges()) stack.push_back(e.child);
+        }
+        m.nodes = seen.size();
+        m.nodeBytes = m.nodes * sizeof(TreeNode);
+        m.edgeBytes = m.edges * sizeof(TreeEdge);
+        m.stringBytes = arena.internedBytes();
+        m.internIndexBytes = arena.internIndexBytes();
+        m.arenaUnreachable = arena.bytesUsed() - min(arena.bytesUsed(), m.nodeBytes + m.edgeBytes + m.stringBytes);
+        m.arenaSlack = arena.bytesReserved() - arena.bytesUsed();
+
+        auto text = [](const vector<string> &v) {
+            size_t n = v.capacity() * sizeof(string);
+            for (auto const &s : v) n += s.capacity() > 15 ? s.capacity() + 1 : 0;
+            return n;
+        };
+        m.flatBytes = text(flat.attributes) + text(flat.labels)
+                    + flat.nodes.capacity() * sizeof(FlatNode) + flat.edges.capacity() * sizeof(FlatEdge)
+                    + flat.values.capacity() * sizeof(vector<string>);
+        for (auto const &dict : flat.values) m.flatBytes += text(dict);
+
+        m.lookupBytes = lookup.cells.capacity() * sizeof(uint16_t) + text(lookup.attributes) + text(lookup.labels)
+                      + lookup.strides.capacity() * sizeof(size_t);
+        for (auto const &codes : lookup.valueCodes)
+            m.lookupBytes += codes.bucket_count() * sizeof(void*)
+                           + codes.size() * (sizeof(pair<const string, uint32_t>) + 2 * sizeof(void*));
+        return m;
+    }
+
+    void printMemoryUsage() const {
+        MemoryUsage m = memoryUsage();
+        cout << "Tree memory:\n"
+             << "  nodes            " << setw(10) << m.nodeBytes << " B  (" << m.nodes << " x " << sizeof(TreeNode) << ")\n"
+             << "  edge arrays      " << setw(10) << m.edgeBytes << " B  (" << m.edges << " x " << sizeof(TreeEdge) << ")\n"
+             << "  strings          " << setw(10) << m.stringBytes << " B\n"
+             << "  intern index     " << setw(10) << m.internIndexBytes << " B\n"
+             << "  arena unreachable" << setw(10) << m.arenaUnreachable << " B\n"
+             << "  arena slack      " << setw(10) << m.arenaSlack << " B\n"
+             << "  flat tree        " << setw(10) << m.flatBytes << " B\n"
+             << "  lookup table     " << setw(10) << m.lookupBytes << " B\n";
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // Compile the tree into a dense mixed-radix table over the attributes it tests.
+    // Each tested attribute is one digit whose domain is the set of edge values seen
+    // for it, so prediction becomes one index computation and one load. Returns false
+    // (and keeps plain traversal) when the product of the domains exceeds maxCells.
+    bool compileLookupTable(size_t maxCells = 4096) {
+        lookup = LookupTable{};
+        if (!root || root->leaf) return false;
+
+        unordered_map<string, size_t> attrPos;
+        collectDomains(root, attrPos);
+
+        size_t cellCount = 1;
+        for (size_t a = lookup.attributes.size(); a-- > 0; ) {
+            size_t radix = lookup.valueCodes[a].size();
+            if (radix == 0 || cellCount > maxCells / radix) {
+                lookup = LookupTable{};
+                return false;
+            }
+            lookup.strides[a] = cellCount;
+            cellCount *= radix;
+        }
+
+        // Decode every cell back into attribute values and resolve it once by traversal.
+        vector<vector<string>> valuesByCode(lookup.attributes.size());
+        for (size_t a = 0; a < lookup.attributes.size(); ++a) {
+            valuesByCode[a].resize(lookup.valueCodes[a].size());
+            for (auto const &kv : lookup.valueCodes[a]) valuesByCode[a][kv.second] = kv.first;
+        }
+
+        unordered_map<string, uint16_t> labelIds;
+        unordered_map<string,string> input;
+        lookup.cells.assign(cellCount, LookupTable::UnknownCell);
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            for (size_t a = 0; a < lookup.attributes.size(); ++a) {
+                size_t code = (cell / lookup.strides[a]) % valuesByCode[a].size();
+                input[lookup.attributes[a]] = valuesByCode[a][code];
+            }
+            string lab = traverse(input);
+            if (lab == "Unknown") continue;
+            auto it = labelIds.find(lab);
+            if (it == labelIds.end()) {
+                if (lookup.labels.size() >= LookupTable::UnknownCell) {
+                    lookup = LookupTable{};
+                    return false;
+                }
+                it = labelIds.emplace(lab, static_cast<uint16_t>(lookup.labels.size())).first;
+                lookup.labels.push_back(lab);
+            }
+            lookup.cells[cell] = it->second;
+        }
+        return true;
+    }
+
+    bool hasLookupTable() const {
+        return !lookup.cells.empty();
+    }
+
+    // Print tree textually (shared DAG nodes are expanded under every parent)
+    void printTree(TreeNode *node = nullptr, const string &indent = "", const string &edgeValue = "", const string &path = "") const {
+        if (!node) {
+            if (!root) {
+                cout << "Tree is empty.\n";
+                return;
+            }
+            node = root;
+        }
+
+        string fullPath = path;
+        if (!edgeValue.empty()) {
+            if (!fullPath.empty()) fullPath += " -> ";
+            fullPath += edgeValue;
+        }
+
+        if (node->leaf) {
+            cout << indent << "├── " << fullPath << ": Leaf = " << node->label << "\n";
+            return;
+        }
+
+        if (!edgeValue.empty()) {
+            cout << indent << "├── " << edgeValue << ": Attribute = " << node->attribute << "\n";
+        } else {
+            cout << indent << "Attribute = " << node->attribute << "\n";
+        }
+
+        for (const auto &e : node->edges()) {
+            printTree(e.child, indent + "│   ", string(e.value), fullPath);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // Predict method: use the compiled lookup table when every digit resolves,
+    // otherwise traverse tree based on input attribute values
+    string predict(const unordered_map<string,string> &input) const {
+        AllocScope scope(AllocSubsystem::Predictor);
+        uint64_t start = metricsNow();
+        string lab = resolve(input);
+        Metrics::global().predictLatency.record(metricsNow() - start);
+        Metrics::global().countRows(1, lab == "Unknown");
+        return lab;
+    }
+
+private:
+    friend struct TreeBench;            // bench.cpp times the private training kernels
+
+    string resolve(const unordered_map<string,string> &input) const {
+        if (!lookup.cells.empty()) {
+            size_t cell = 0;
+            bool resolved = true;
+            for (size_t a = 0; a < lookup.attributes.size() && resolved; ++a) {
+                auto it = input.find(lookup.attributes[a]);
+                if (it == input.end()) { resolved = false; break; }
+                auto codeIt = lookup.valueCodes[a].find(it->second);
+                if (codeIt == lookup.valueCodes[a].end()) { resolved = false; break; }
+                cell += codeIt->second * lookup.strides[a];
+            }
+            if (resolved) {
+                uint16_t lab = lookup.cells[cell];
+                return lab == LookupTable::UnknownCell ? "Unknown" : lookup.labels[lab];
+            }
+        }
+        return traverse(input);
+    }
+
+    // Dense table produced by compileLookupTable(); empty when the space is too large.
+    struct LookupTable {
+        static constexpr uint16_t UnknownCell = 0xFFFF;
+        vector<string> attributes;                          // one digit per tested attribute
+        vector<unordered_map<string, uint32_t>> valueCodes; // edge value -> digit
+        vector<size_t> strides;
+        vector<string> labels;
+        vector<uint16_t> cells;                             // label index or UnknownCell
+    };
+
+    NodeArena   arena;
+    TreeNode   *root     = nullptr;
+    DataSheet  *dataFile = nullptr;
+    vector<string> headers;
+    LookupTable lookup;
+    FlatTree flat;
+
+    string traverse(const unordered_map<string,string> &input) const {
+        TreeNode* node = root;
+        while (node && !node->leaf) {
+            auto it = input.find(string(node->attribute));
+            if (it == input.end()) return "Unknown";
+            node = node->child(it->second);
+        }
+        return node ? string(node->label) : "Unknown";
+    }
+
+    TreeNode* internSubtree(TreeNode *node,
+                            unordered_map<string, TreeNode*> &unique,
+                            unordered_map<TreeNode*, TreeNode*> &canonical,
+                            unordered_map<TreeNode*, size_t> &ids) {
+        if (!node) return nullptr;
+        auto done = canonical.find(node);
+        if (done != canonical.end()) return done->second;
+
+        for (auto &e : node->edges())
+            e.child = internSubtree(e.child, unique, canonical, ids);
+
+        // Signature: kind + name, then (value, child id) pairs in value order
+        string key = node->leaf ? "L" + string(node->label) : "A" + string(node->attribute);
+        for (auto const &e : node->edges()) {
+            key += '\n' + to_string(e.value.size()) + ':';
+            key += e.value;
+            key += '=' + to_string(ids.at(e.child));
+        }
+
+        auto it = unique.emplace(key, node).first;
+        if (it->second == node) ids.emplace(node, ids.size());
+        canonical[node] = it->second;
+        return it->second;
+    }
+
+    void collectDomains(TreeNode *node, unordered_map<string, size_t> &attrPos) {
+        if (!node || node->leaf) return;
+
+        string attr(node->attribute);
+        auto pos = attrPos.find(attr);
+        if (pos == attrPos.end()) {
+            pos = attrPos.emplace(attr, lookup.attributes.size()).first;
+            lookup.attributes.push_back(attr);
+            lookup.valueCodes.emplace_back();
+            lookup.strides.push_back(0);
+        }
+        for (auto const &e : node->edges()) {
+            auto &codes = lookup.valueCodes[pos->second];
+            codes.emplace(string(e.value), static_cast<uint32_t>(codes.size()));
+            collectDomains(e.child, attrPos);
+        }
+    }
+// Live viewer feed: the node buildTree creates next hangs off feedParent by feedEdge
+uint32_t feedParent = TrainingFeed::NoNode;
+string_view feedEdge;
+
+uint32_t publishNode(const TreeNode &node) {
+    if (!TrainingFeed::global().isEnabled()) return TrainingFeed::NoNode;
+    return TrainingFeed::global().publish({feedParent, feedEdge, node.attribute, node.label, node.leaf});
+}
+
+TreeNode* makeLeaf(const string &label) {
+    TreeNode *leaf = arena.make<TreeNode>(LeafLabel{arena.intern(label)});
+    publishNode(*leaf);
+    return leaf;
+}
+
+TreeNode* buildTree(const vector<vector<string>>& data,
+                    const vector<string>& headers,
+                    int depth = 0) {
+    int rowCount = data.size();
+    int colCount = headers.size();
+    int labelIdx = colCount - 1;
+
+    TraceSpan span("buildTree");
+    span.arg("rows", rowCount - 1).arg("depth", depth);
+    ostream *log = TrainingLog::global().out;
+    TrainingProgress::global().enterNode(static_cast<uint32_t>(depth));
+
+    // Check if all labels are the same
+    const string& firstLab = data[1][labelIdx];
+    bool allSame = true;
+    for (int i = 2; i < rowCount; ++i) {
+        if (data[i][labelIdx] != firstLab) {
+            allSame = false;
+            break;
+        }
+    }
+    if (allSame) {
+        if (log) {
+            printIndent(*log, depth);
+            *log << "All labels = " << firstLab << " → Leaf\n";
+        }
+        span.arg("leaf", firstLab);
+        TrainingProgress::global().addLeaf(rowCount - 1);
+        return makeLeaf(firstLab);
+    }
+
+    // If only label left, choose majority
+    if (colCount <= 2) {
+        unordered_map<string,int> freq;
+        for (int i = 1; i < rowCount; ++i)
+            freq[data[i][labelIdx]]++;
+        string maj; int bestC = 0;
+        for (auto& kv : freq)
+            if (kv.second > bestC || (kv.second == bestC && kv.first < maj)) maj = kv.first, bestC = kv.second;
+
+        if (log) {
+            printIndent(*log, depth);
+            *log << "No attributes left → majority = " << maj << "\n";
+        }
+        span.arg("leaf", maj);
+        TrainingProgress::global().addLeaf(rowCount - 1);
+        return makeLeaf(maj);
+    }
+
+    // Select best attribute by IG
+    if (log) {
+        printIndent(*log, depth);
+        *log << "Calculating gains for attributes:\n";
+    }
+    int bestIdx = -1;
+    double bestGain = -1.0;
+    {
+        TraceSpan search("splitSearch");
+        PerfScope counters(PerfCounters::SplitSearch);
+        search.arg("rows", rowCount - 1).arg("candidates", colCount - 1);
+        for (int i = 0; i < colCount - 1; ++i) {
+            if (log) {
+                printIndent(*log, depth);
+                *log << "- Attribute \"" << headers[i] << "\":\n";
+            }
+            double gain = calculateIG_OnSubset(data, i, depth+1);
+            if (gain > bestGain + GainTolerance) {
+                bestGain = gain;
+                bestIdx = i;
+            }
+        }
+    }
+
+    // If no gain, fallback to majority
+    if (bestIdx < 0) {
+        unordered_map<string,int> freq;
+        for (int i = 1; i < rowCount; ++i)
+            freq[data[i][labelIdx]]++;
+        string maj; int bestC = 0;
+        for (auto& kv : freq)
+            if (kv.second > bestC || (kv.second == bestC && kv.first < maj)) maj = kv.first, bestC = kv.second;
+
+        if (log) {
+            printIndent(*log, depth);
+            *log << "All gains ≤ 0 → majority = " << maj << "\n";
+        }
+        span.arg("leaf", maj);
+        TrainingProgress::global().addLeaf(rowCount - 1);
+        return makeLeaf(maj);
+    }
+
+    // Split on best attribute
+    string bestAttr = headers[bestIdx];
+    if (log) {
+        printIndent(*log, depth);
+        *log << "Best attribute = " << bestAttr
+             << " (Gain=" << fixed << setprecision(3) << bestGain << ")\n";
+    }
+
+    TreeNode* node = arena.make<TreeNode>(arena.intern(bestAttr));
+    uint32_t feedId = publishNode(*node);
+    span.arg("attribute", bestAttr);
+
+    // Partition data
+    unordered_map<string, vector<vector<string>>> partitions = partitionRows(data, bestIdx);
+    TrainingProgress::global().addSplit(partitions.size());
+
+    // New headers
+    vector<string> newHeaders = headers;
+    newHeaders.erase(newHeaders.begin() + bestIdx);
+
+    // Build children into a compact edge array, sorted by value for lookups
+    node->children = arena.makeArray<TreeEdge>(partitions.size());
+    node->childCount = static_cast<uint32_t>(partitions.size());
+    TreeEdge *edge = node->children;
+    for (auto& kv : partitions) {
+        TraceSpan child("child");
+        child.arg("value", kv.first).arg("rows", static_cast<long long>(kv.second.size()));
+        if (log) {
+            printIndent(*log, depth);
+            *log << "→ Creating subtree for " << bestAttr
+                 << " = " << kv.first << ":\n";
+        }
+        // Build subset
+        vector<vector<string>> subset;
+        subset.push_back(newHeaders);
+        for (auto& r : kv.second) subset.push_back(r);
+        edge->value = arena.intern(kv.first);
+        feedParent = feedId;
+        feedEdge = edge->value;
+        edge->child = buildTree(subset, newHeaders, depth+1);
+        ++edge;
+    }
+    sort(node->children, node->children + node->childCount,
+         [](const TreeEdge &a, const TreeEdge &b) { return a.value < b.value; });
+
+    return node;
+}
+    // Group the data rows by their value of column attrIdx, dropping that column
+    unordered_map<string, vector<vector<string>>> partitionRows(const vector<vector<string>>& data,
+                                                                int attrIdx) const {
+        TraceSpan span("partition");
+        PerfScope counters(PerfCounters::Partition);
+        span.arg("rows", static_cast<long long>(data.size()) - 1).arg("attribute", data[0][attrIdx]);
+        unordered_map<string, vector<vector<string>>> partitions;
+        for (size_t i = 1; i < data.size(); ++i) {
+            string val = data[i][attrIdx];
+            vector<string> row = data[i];
+            row.erase(row.begin() + attrIdx);
+            partitions[val].push_back(row);
+        }
+        span.arg("parts", static_cast<long long>(partitions.size()));
+        return partitions;
+    }
+    double calculateIG_OnSubset(const vector<vector<string>>& subset,
+                                int attrIdx,
+                                int depth) {
+        int rowCount = subset.size();
+        int labelIdx = subset[0].size() - 1;
+
+        TraceSpan span("calculateIG");
+        span.arg("attribute", subset[0][attrIdx]).arg("rows", rowCount - 1);
+
+        // Gather labels
+        vector<string> labels;
+        for (int i = 1; i < rowCount; ++i)
+            labels.push_back(subset[i][labelIdx]);
+
+        ostream *log = TrainingLog::global().out;
+        if (log) {
+            printIndent(*log, depth);
+            *log << "Base entropy for this node:\n";
+        }
+        double baseEnt = calculateEntropy(labels, depth+1);
+
+        // Partition by attribute values
+        unordered_map<string, vector<string>> parts;
+        for (int i = 1; i < rowCount; ++i) {
+            parts[subset[i][attrIdx]].push_back(subset[i][labelIdx]);
+        }
+
+        // Compute remainder
+        double remainder = 0.0;
+        for (auto& kv : parts) {
+            const string& val = kv.first;
+            auto& labs = kv.second;
+            double weight = double(labs.size()) / labels.size();
+
+            if (log) {
+                printIndent(*log, depth);
+                *log << "Split \"" << val << "\" (" << labs.size() << "/" << labels.size() << "):\n";
+            }
+            double partEnt = calculateEntropy(labs, depth+1);
+            remainder += weight * partEnt;
+        }
+
+        double gain = baseEnt - remainder;
+        if (log) {
+            printIndent(*log, depth);
+            *log << "Information Gain = "
+                 << fixed << setprecision(3) << baseEnt
+                 << " - " << remainder
+                 << " = " << gain << "\n\n";
+        }
+        return gain;
+    }
+    double calculateEntropy(const vector<string>& labels, int depth) {
+    unordered_map<string,int> freq;
+    for (auto& lab : labels) freq[lab]++;
+    double entropy = 0.0;
+    int n = labels.size();
+
+    for (auto& kv : freq) {
+        double p = double(kv.second) / n;
+        entropy -= p * log2(p);
+    }
+
+    if (ostream *log = TrainingLog::global().out) {
+        printIndent(*log, depth);
+        *log << "Entropy calc for ";
+        for (auto& kv : freq) *log << kv.first << ":" << kv.second << " ";
+        *log << "→ " << fixed << setprecision(3) << entropy << "\n";
+    }
+    return entropy;
+}
+};
+
+
+// Function to split a string by a delimiter
+inline vector<string> split(const string& line, char delimiter) {
+    vector<string> tokens;
+    string token;
+    istringstream tokenStream(line);
+    while (getline(tokenStream, token, delimiter)) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// Parse the numeric value of a command-line flag. Garbage, trailing characters and values
+// out of T's range are reported on cerr and return false instead of throwing.
+template <class T>
+bool parseNumber(const string &flag, const string &text, T &out) {
+    try {
+        size_t used = 0;
+        if constexpr (is_floating_point_v<T>) {
+            out = static_cast<T>(stod(text, &used));
+            if (used == text.size()) return true;
+        } else if constexpr (is_signed_v<T>) {
+            long long v = stoll(text, &used);
+            if (used == text.size() && v >= numeric_limits<T>::min() && v <= numeric_limits<T>::max()) {
+                out = static_cast<T>(v);
+                return true;
+            }
+        } else {
+            unsigned long long v = stoull(text, &used);
+            if (used == text.size() && text.find('-') == string::npos && v <= numeric_limits<T>::max()) {
+                out = static_cast<T>(v);
+                return true;
+            }
+        }
+    } catch (const invalid_argument&) {
+    } catch (const out_of_range&) {
+    }
+    cerr << "Invalid value for " << flag << ": \"" << text << "\"\n";
+    return false;
+}
+
+// Function to read CSV/TXT file with a given delimiter
+inline vector<vector<string>> readTableFromFile(const string& filename, char delimiter) {
+    vector<vector<string>> table;
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error opening file: " << filename << "\n";
+        return table;
+    }
+
+    string line;
+    while (getline(file, line)) {
+        vector<string> row = split(line, delimiter);
+        table.push_back(row);
+    }
+
+    file.close();
+    return table;
+}
@@ -0,0 +1,260 @@
+// equivalence_test.cpp
+//
+// Checks that every way of getting a model agrees with the in-memory build on the bundled
+// datasets and on generated tables (the gen_data generator with fixed seeds):
+//   - train --external, at the default and at a 64 KB memory budget, saves the same bytes
+//   - update, appending the rows in steps with the state saved and loaded in between,
+//     saves after every step the bytes a full train on the rows so far saves, and so
+//     does update --rebuild
+//   - the lookup table, the merged tree, the flat tree and the mapped model file all
+//     predict what the tree as built (before identical subtrees are merged) predicts, on
+//     the training rows and on rows that mix their values or carry unseen ones
+//
+//   equivalence_test <data dir> [--temp-dir DIR]
+//
+// Exit status: 0 pass, 1 a check failed, 2 the test could not be set up.
+
+#include "decision_tree.h"
+#include "external_training.h"
+#include "incremental_training.h"
+#include "synth_data.h"
+
+#include <filesystem>
+
+static string fileBytes(const string &path) {
+    ifstream file(path, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+// The tree buildTree grew, rebuilt from the TrainingFeed before compile() merges it
+class FeedTree {
+public:
+    FeedTree(const TrainingFeed &feed, const vector<string> &headers) {
+        nodes.resize(feed.size());
+        for (size_t i = 0; i < feed.size(); ++i) {
+            const TrainingFeed::Event &e = feed[i];
+            nodes[i].attribute = e.leaf ? -1 : columnOf(headers, e.attribute);
+            nodes[i].label = e.label;
+            if (e.parent != TrainingFeed::NoNode) nodes[e.parent].children.emplace_back(e.edge, i);
+        }
+    }
+
+    string predict(const vector<string> &row) const {
+        size_t at = 0;
+        while (!nodes.empty() && nodes[at].attribute >= 0) {
+            const string &value = row[nodes[at].attribute];
+            auto const &kids = nodes[at].children;
+            auto it = find_if(kids.begin(), kids.end(), [&](auto const &c) { return c.first == value; });
+            if (it == kids.end()) return "Unknown";
+            at = it->second;
+        }
+        return nodes.empty() ? "Unknown" : string(nodes[at].label);
+    }
+
+private:
+    struct Node {
+        int attribute = -1;
+        string_view label;
+        vector<pair<string_view, size_t>> children;
+    };
+    vector<Node> nodes;
+
+    static int columnOf(const vector<string> &headers, string_view name) {
+        return static_cast<int>(find(headers.begin(), headers.end(), name) - headers.begin());
+    }
+};
+
+class Checker {
+public:
+    int failures = 0;
+
+    void expect(bool ok, const string &dataset, const string &what) {
+        failures += !ok;
+        cout << (ok ? "ok   " : "FAIL ") << dataset << ": " << what << "\n";
+    }
+};
+
+// The header plus rows [from, to) of a CSV held as lines
+static string csvSlice(const vector<string> &lines, size_t from, size_t to) {
+    string out = lines[0] + "\n";
+    for (size_t i = from; i < to; ++i) out += lines[i] + "\n";
+    return out;
+}
+
+static bool trainInMemory(const string &csv, const string &path) {
+    istringstream in(csv);
+    DataSheet sheet(in);
+    DecisionTree tree(&sheet);
+    return tree.saveModel(path);
+}
+
+static void checkTraining(Checker &check, const string &name, const string &csv, const string &base) {
+    vector<string> lines;
+    {
+        istringstream in(csv);
+        string line;
+        while (getline(in, line))
+            if (!line.empty()) lines.push_back(line);
+    }
+    string expectedPath = base + "-memory.bin", path = base + "-other.bin", state = base + "-state";
+    if (!trainInMemory(csv, expectedPath)) {
+        check.expect(false, name, "in-memory train saves a model");
+        return;
+    }
+    string expected = fileBytes(expectedPath);
+
+    // 64 KB leaves nothing for count tables once the stream buffers are taken, so every
+    // open node gets a counting pass of its own
+    for (size_t budget : {ExternalOptions{}.memoryBudget, size_t(64) << 10}) {
+        ExternalOptions options;
+        options.memoryBudget = budget;
+        options.tempDir = filesystem::path(base).parent_path().string();
+        ExternalTrainer trainer(options);
+        istringstream in(csv);
+        unique_ptr<DecisionTree> tree;
+        if (trainer.encode(in)) tree = trainer.train();
+        check.expect(tree && tree->saveModel(path) && fileBytes(path) == expected, name,
+                     "external train with a " + to_string(budget >> 10) + " KB budget matches in-memory");
+    }
+
+    // Three appends, the state going through a file between them
+    size_t rows = lines.size() - 1;
+    size_t cuts[] = {1, 1 + rows / 2, 1 + rows * 5 / 6, lines.size()};
+    bool same = true;
+    for (int step = 0; step < 3 && same; ++step) {
+        IncrementalTrainer trainer;
+        if (step > 0 && !trainer.load(state)) {
+            same = false;
+            break;
+        }
+        istringstream in(csvSlice(lines, cuts[step], cuts[step + 1]));
+        unique_ptr<DecisionTree> tree;
+        if (trainer.append(in)) tree = trainer.snapshot();
+        string prefixPath = base + "-prefix.bin";
+        same = tree && trainer.save(state) && tree->saveModel(path) &&
+               trainInMemory(csvSlice(lines, 1, cuts[step + 1]), prefixPath) &&
+               fileBytes(path) == fileBytes(prefixPath);
+        remove(prefixPath.c_str());
+    }
+    check.expect(same, name, "update in 3 steps matches in-memory after every step");
+
+    IncrementalTrainer rebuilt;
+    unique_ptr<DecisionTree> tree;
+    if (rebuilt.load(state)) {
+        rebuilt.rebuild();
+        tree = rebuilt.snapshot();
+    }
+    check.expect(tree && tree->saveModel(path) && fileBytes(path) == expected, name,
+                 "update --rebuild matches in-memory");
+
+    remove(expectedPath.c_str());
+    remove(path.c_str());
+    remove(state.c_str());
+}
+
+static void checkPredictors(Checker &check, const string &name, const string &csv, const string &base) {
+    istringstream in(csv);
+    DataSheet sheet(in);
+    const auto &table = sheet.getData();
+    const vector<string> &headers = table[0];
+    size_t attributes = headers.size() - 1;
+
+    TrainingFeed &feed = TrainingFeed::global();
+    feed.enable();
+    DecisionTree tree(&sheet);
+    feed.finish();
+    FeedTree built(feed, headers);
+
+    // Training rows, then rows mixing values of different rows, then rows with one unseen value
+    vector<vector<string>> rows(table.begin() + 1, table.end());
+    size_t n = rows.size();
+    for (size_t i = 0; i < n; ++i) {
+        vector<string> mixed = rows[i];
+        for (size_t a = 0; a < attributes; ++a) mixed[a] = rows[(i * 7 + a * 13) % n][a];
+        rows.push_back(std::move(mixed));
+        vector<string> unseen = rows[i];
+        unseen[i % attributes] = "<unseen>";
+        rows.push_back(std::move(unseen));
+    }
+
+    string path = base + "-model.bin";
+    MappedModel model;
+    bool opened = tree.saveModel(path) && model.open(path);
+    vector<string> flat = tree.predictBatch(rows);
+    size_t lookupDiffs = 0, flatDiffs = 0, mappedDiffs = 0;
+    for (size_t r = 0; r < rows.size(); ++r) {
+        string expected = built.predict(rows[r]);
+        unordered_map<string, string> input;
+        for (size_t a = 0; a < attributes; ++a) input[headers[a]] = rows[r][a];
+        lookupDiffs += tree.predict(input) != expected;
+        flatDiffs += flat[r] != expected;
+        if (!opened) continue;
+        uint32_t lab = model.predictRow(rows[r]);
+        mappedDiffs += (lab == MappedModel::None ? "Unknown" : string(model.label(lab))) != expected;
+    }
+    string counted = " on " + to_string(rows.size()) + " rows";
+    check.expect(lookupDiffs == 0, name, "lookup table and merged tree match the tree as built" + counted);
+    check.expect(flatDiffs == 0, name, "flat tree matches the tree as built" + counted);
+    check.expect(opened && mappedDiffs == 0, name, "mapped model matches the tree as built" + counted);
+    remove(path.c_str());
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <data dir> [--temp-dir DIR]\n";
+        return 2;
+    }
+    filesystem::path dir = filesystem::temp_directory_path();
+    for (int i = 2; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--temp-dir" && i + 1 < argc) dir = argv[++i];
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 2;
+        }
+    }
+    TrainingLog::global().out = nullptr;
+
+    vector<pair<string, string>> datasets;
+    for (string name : {"weather.csv", "contact_lenses.csv", "breast_cancer.csv"}) {
+        ifstream file(string(argv[1]) + "/" + name);
+        if (!file.is_open()) {
+            cerr << "Could not open " << name << " in " << argv[1] << "\n";
+            return 2;
+        }
+        stringstream csv;
+        csv << file.rdbuf();
+        datasets.emplace_back(name, csv.str());
+    }
+    // gen_data tables: a clean planted tree, noisy multi-class, skewed wide
+    SynthSpec clean, noisy, skewed;
+    clean.rows = 3000;
+    clean.noise = 0.0;
+    noisy.rows = 5000;
+    noisy.attributes = 8;
+    noisy.defaultCardinality = 5;
+    noisy.classes = 4;
+    noisy.noise = 0.15;
+    noisy.seed = 7;
+    skewed.rows = 4000;
+    skewed.attributes = 10;
+    skewed.defaultCardinality = 3;
+    skewed.classes = 3;
+    skewed.skew = 1.5;
+    skewed.depth = 5;
+    skewed.seed = 11;
+    for (auto const &[name, spec] : {pair{"gen-clean", clean}, pair{"gen-noisy", noisy}, pair{"gen-skewed", skewed}}) {
+        ostringstream csv;
+        SyntheticData(spec).writeCsv(csv);
+        datasets.emplace_back(name, csv.str());
+    }
+
+    Checker check;
+    string base = (dir / ("equivalence_test-" + to_string(getpid()))).string();
+    for (auto const &[name, csv] : datasets) {
+        checkTraining(check, name, csv, base);
+        checkPredictors(check, name, csv, base);
+    }
+    cout << (check.failures ? to_string(check.failures) + " check(s) failed\n" : string("all checks passed\n"));
+    return check.failures ? 1 : 0;
+}
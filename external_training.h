@@ -0,0 +1,522 @@
+// external_training.h
+//
+// Out-of-core training for datasets larger than memory. One pass over the input turns
+// every column into a file of u32 dictionary codes; the tree then grows level by level.
+// Each level is one sequential pass over those files that routes every row through the
+// splits chosen on the level before and counts (attribute value x class) for all open
+// nodes of the level at once. Each row's node is kept in a node file rewritten on every
+// pass, and once at most half of the rows are still open the pass also writes compacted
+// files holding only those rows and the attributes still in play. When the count tables
+// of a level do not fit the memory budget they are filled in groups, one pass per group.
+//
+// Splits follow buildTree: the same information gain, the first attribute wins ties,
+// a node becomes a leaf once it is pure or has at most one attribute left, and a
+// majority leaf takes the smallest of tied labels. Memory
+// holds the value dictionaries, one entry per open node, the count tables and the
+// stream buffers; the rows themselves stay on disk.
+//
+//   dtree train <data.csv | -> <model.bin> --external [--memory-budget MB] [--temp-dir DIR]
+
+#pragma once
+
+#include "decision_tree.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <numeric>
+
+struct ExternalOptions {
+    string tempDir;                             // default: $TMPDIR, else /tmp
+    size_t memoryBudget = size_t(512) << 20;    // count tables plus stream buffers
+    char delimiter = ',';
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// CodeWriter / CodeReader: sequential u32 streams over a temporary file with a fixed
+// buffer. Errors are sticky and checked once, at close().
+// ————————————————————————————————————————————————————————————————————————————————
+class CodeWriter {
+public:
+    CodeWriter() = default;
+    CodeWriter(const CodeWriter&) = delete;
+    CodeWriter& operator=(const CodeWriter&) = delete;
+    ~CodeWriter() { if (file) fclose(file); }
+
+    bool open(const string &path, size_t bufferCodes) {
+        file = fopen(path.c_str(), "wb");
+        buf.resize(bufferCodes);
+        used = 0;
+        ok = file != nullptr;
+        return ok;
+    }
+
+    void put(uint32_t code) {
+        buf[used++] = code;
+        if (used == buf.size()) flush();
+    }
+
+    bool close() {
+        if (!file) return ok;
+        flush();
+        ok = fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    FILE *file = nullptr;
+    vector<uint32_t> buf;
+    size_t used = 0;
+    bool ok = true;
+
+    void flush() {
+        if (used && fwrite(buf.data(), sizeof(uint32_t), used, file) != used) ok = false;
+        used = 0;
+    }
+};
+
+class CodeReader {
+public:
+    CodeReader() = default;
+    CodeReader(const CodeReader&) = delete;
+    CodeReader& operator=(const CodeReader&) = delete;
+    ~CodeReader() { if (file) fclose(file); }
+
+    bool open(const string &path, size_t bufferCodes) {
+        file = fopen(path.c_str(), "rb");
+        buf.resize(bufferCodes);
+        pos = end = 0;
+        ok = file != nullptr;
+        return ok;
+    }
+
+    // The caller knows how many codes the file holds; reading past the end marks an error
+    uint32_t get() {
+        if (pos == end) {
+            end = file ? fread(buf.data(), sizeof(uint32_t), buf.size(), file) : 0;
+            pos = 0;
+            if (end == 0) {
+                ok = false;
+                return 0;
+            }
+        }
+        return buf[pos++];
+    }
+
+    bool close() {
+        if (file) fclose(file);
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    FILE *file = nullptr;
+    vector<uint32_t> buf;
+    size_t pos = 0, end = 0;
+    bool ok = true;
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// ExternalTrainer: encode() streams the input once, train() grows the tree from the
+// column files. Temporary files live in a private directory removed with the trainer.
+// ————————————————————————————————————————————————————————————————————————————————
+class ExternalTrainer {
+public:
+    explicit ExternalTrainer(ExternalOptions options)
+        : options(std::move(options)) {}
+
+    ExternalTrainer(const ExternalTrainer&) = delete;
+    ExternalTrainer& operator=(const ExternalTrainer&) = delete;
+    ~ExternalTrainer() {
+        if (dir.empty()) return;
+        error_code ec;
+        filesystem::remove_all(dir, ec);
+    }
+
+    // Read the header and every row; each column becomes a file of dictionary codes
+    bool encode(istream &in) {
+        PhaseTimer timer(Metrics::Phase::Load);
+        AllocScope scope(AllocSubsystem::Loader);
+        if (!makeTempDir()) return false;
+
+        string line;
+        if (!getline(in, line)) {
+            cerr << "Input is empty, expected a header line\n";
+            return false;
+        }
+        DataSheet::splitDelimiter(line, headers, options.delimiter);
+        if (headers.size() < 2) {
+            cerr << "Need at least one attribute column and a label column\n";
+            return false;
+        }
+        size_t columns = headers.size();
+        dictionary.assign(columns, {});
+        values.assign(columns, {});
+        present.assign(columns, true);
+        rootClasses.clear();
+
+        vector<CodeWriter> writers(columns);
+        for (size_t c = 0; c < columns; ++c) {
+            if (!writers[c].open(columnPath(c), bufferCodes(columns))) {
+                cerr << "Could not create " << columnPath(c) << "\n";
+                return false;
+            }
+        }
+        vector<string> fields;
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            DataSheet::splitDelimiter(line, fields, options.delimiter);
+            if (fields.size() != columns) {
+                cerr << "Row " << totalRows + 1 << " has " << fields.size() << " fields, expected " << columns << "\n";
+                return false;
+            }
+            uint32_t label = 0;
+            for (size_t c = 0; c < columns; ++c) {
+                auto [it, added] = dictionary[c].try_emplace(fields[c], static_cast<uint32_t>(values[c].size()));
+                if (added) values[c].push_back(fields[c]);
+                writers[c].put(it->second);
+                label = it->second;
+            }
+            if (label == rootClasses.size()) rootClasses.push_back(0);
+            ++rootClasses[label];
+            ++totalRows;
+        }
+        for (size_t c = 0; c < columns; ++c) {
+            if (!writers[c].close()) {
+                cerr << "Error writing " << columnPath(c) << "\n";
+                return false;
+            }
+        }
+        if (totalRows == 0) {
+            cerr << "Input has no data rows\n";
+            return false;
+        }
+        if (totalRows >= Closed) {
+            cerr << "External training supports at most " << Closed - 1 << " rows\n";
+            return false;
+        }
+        rowCount = totalRows;
+        return true;
+    }
+
+    // Grow the tree; nullptr (with a message on cerr) if a temporary file fails
+    unique_ptr<DecisionTree> train() {
+        failed = false;
+        auto tree = make_unique<DecisionTree>(headers, [this](NodeArena &arena) { return grow(arena); });
+        if (failed) return nullptr;
+        return tree;
+    }
+
+    size_t passes() const { return passCount; }
+
+private:
+    static constexpr uint32_t Closed = UINT32_MAX;
+
+    // A node whose split is chosen after the next pass has counted its rows
+    struct Open {
+        TreeNode **slot;                // the root pointer or the parent's edge
+        vector<uint32_t> attributes;    // candidate columns, in header order
+        vector<uint64_t> classes;       // rows per label code
+        uint64_t rows;
+        uint32_t depth;
+    };
+
+    // A split chosen on the previous level: value code -> open node of this level
+    struct Split {
+        uint32_t attribute;
+        vector<uint32_t> route;         // Closed where the value led to a leaf
+    };
+
+    ExternalOptions options;
+    string dir;
+    vector<string> headers;
+    vector<unordered_map<string, uint32_t>> dictionary;
+    vector<vector<string>> values;      // per column, by code
+    vector<uint64_t> rootClasses;
+    vector<bool> present;               // columns with a file in the current generation
+    uint64_t totalRows = 0;
+    uint64_t rowCount = 0;              // rows in the current files
+    uint32_t generation = 0;            // bumped when the files are compacted
+    uint32_t level = 0;
+    bool hasNodeFile = false;
+    bool failed = false;
+    size_t passCount = 0;
+
+    size_t labelColumn() const { return headers.size() - 1; }
+    uint32_t classCount() const { return static_cast<uint32_t>(values.back().size()); }
+
+    string columnPath(size_t c) const { return columnPath(c, generation); }
+    string columnPath(size_t c, uint32_t gen) const {
+        return dir + "/col" + to_string(c) + "-" + to_string(gen) + ".u32";
+    }
+    string nodePath(uint32_t l) const {
+        return dir + "/node" + to_string(l) + ".u32";
+    }
+
+    // A pass streams at most every column and a node file in and out again
+    size_t bufferCodes(size_t columns) const {
+        size_t streams = 2 * (columns + 1);
+        return clamp<size_t>(options.memoryBudget / 4 / streams / sizeof(uint32_t), 4096, 256 * 1024);
+    }
+
+    bool makeTempDir() {
+        string base = options.tempDir;
+        if (base.empty()) base = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+        string pattern = base + "/dtree-external-XXXXXX";
+        if (!mkdtemp(pattern.data())) {
+            cerr << "Could not create a temporary directory in " << base << "\n";
+            return false;
+        }
+        dir = pattern;
+        return true;
+    }
+
+    static double entropy(const uint64_t *classes, uint32_t k, uint64_t rows) {
+        double e = 0.0;
+        for (uint32_t c = 0; c < k; ++c) {
+            if (!classes[c]) continue;
+            double p = double(classes[c]) / double(rows);
+            e -= p * log2(p);
+        }
+        return e;
+    }
+
+    // Majority label, the smallest one on ties as in buildTree
+    TreeNode* leaf(NodeArena &arena, const vector<uint64_t> &classes, uint64_t rows) {
+        const vector<string> &labels = values[labelColumn()];
+        uint32_t best = 0;
+        for (uint32_t c = 1; c < classes.size(); ++c)
+            if (classes[c] > classes[best] || (classes[c] == classes[best] && labels[c] < labels[best])) best = c;
+        TrainingProgress::global().addLeaf(rows);
+        return arena.make<TreeNode>(LeafLabel{arena.intern(labels[best])});
+    }
+
+    // Place a node in *slot: a leaf when buildTree would stop here, otherwise an open node
+    // of the next level. Returns its index in `next`, or Closed for a leaf.
+    uint32_t addNode(NodeArena &arena, TreeNode **slot, vector<uint32_t> attributes,
+                     vector<uint64_t> classes, uint64_t rows, uint32_t depth, vector<Open> &next) {
+        TrainingProgress::global().enterNode(depth);
+        size_t labelsSeen = count_if(classes.begin(), classes.end(), [](uint64_t n) { return n > 0; });
+        if (labelsSeen <= 1 || attributes.size() <= 1) {
+            *slot = leaf(arena, classes, rows);
+            return Closed;
+        }
+        next.push_back({slot, std::move(attributes), std::move(classes), rows, depth});
+        return static_cast<uint32_t>(next.size() - 1);
+    }
+
+    TreeNode* grow(NodeArena &arena) {
+        TreeNode *root = nullptr;
+        TrainingProgress::global().begin(totalRows);
+        vector<uint32_t> all(labelColumn());
+        iota(all.begin(), all.end(), 0u);
+        vector<Open> frontier;
+        addNode(arena, &root, all, rootClasses, totalRows, 0, frontier);
+
+        vector<Split> splits;
+        while (!frontier.empty() && !failed) {
+            vector<Open> next;
+            vector<Split> chosen = growLevel(arena, frontier, splits, next);
+            frontier = std::move(next);
+            splits = std::move(chosen);
+            ++level;
+        }
+        TrainingProgress::global().finish();
+        if (failed) return nullptr;
+        return root;
+    }
+
+    // One level: count every open node (in budget-sized groups), choose its split and
+    // create its children. Returns the splits, indexed like `frontier`.
+    vector<Split> growLevel(NodeArena &arena, vector<Open> &frontier, const vector<Split> &previous,
+                            vector<Open> &next) {
+        uint32_t k = classCount();
+        vector<bool> keep(headers.size(), false);
+        uint64_t openRows = 0;
+        for (auto const &o : frontier) {
+            openRows += o.rows;
+            for (uint32_t a : o.attributes) keep[a] = true;
+        }
+        keep[labelColumn()] = true;
+        bool compact = openRows * 2 <= rowCount;
+
+        size_t streamBytes = 2 * (headers.size() + 1) * bufferCodes(headers.size()) * sizeof(uint32_t);
+        size_t tableBudget = options.memoryBudget > streamBytes ? options.memoryBudget - streamBytes : 0;
+        auto tableSize = [&](const Open &o) {
+            size_t cells = k;
+            for (uint32_t a : o.attributes) cells += values[a].size() * k;
+            return cells;
+        };
+
+        vector<Split> chosen(frontier.size());
+        for (size_t g0 = 0, g1 = 0; g0 < frontier.size() && !failed; g0 = g1) {
+            // Greedy group of open nodes whose tables fit; an oversized node goes alone
+            vector<size_t> offsets{0};
+            for (g1 = g0; g1 < frontier.size(); ++g1) {
+                size_t cells = tableSize(frontier[g1]);
+                if (g1 > g0 && (offsets.back() + cells) * sizeof(uint64_t) > tableBudget) break;
+                offsets.push_back(offsets.back() + cells);
+            }
+            vector<uint64_t> table(offsets.back(), 0);
+            if (!countPass(frontier, previous, g0, g1, offsets, table, g0 == 0, compact, keep)) {
+                failed = true;
+                break;
+            }
+            for (size_t i = g0; i < g1; ++i)
+                chosen[i] = split(arena, frontier[i], table.data() + offsets[i - g0], next);
+        }
+        if (failed) return {};
+
+        // The node file (and compacted columns) written by the first pass become current
+        if (hasNodeFile) remove(nodePath(level - 1).c_str());
+        hasNodeFile = true;
+        if (compact) {
+            for (size_t c = 0; c < headers.size(); ++c)
+                if (present[c]) remove(columnPath(c).c_str());
+            ++generation;
+            present = keep;
+            rowCount = openRows;
+        }
+        if (ostream *log = TrainingLog::global().out) {
+            *log << "[external] level " << level << ": " << frontier.size() << " open nodes, "
+                 << openRows << " rows" << (compact ? " (compacted)" : "") << ", " << next.size()
+                 << " open below, " << passCount << " passes so far\n";
+        }
+        return chosen;
+    }
+
+    // Stream the current files once: route each row through `previous` to its open node
+    // and count it if that node is in [g0, g1). The first pass of a level also writes the
+    // next node file, and the compacted columns when `compact` is set.
+    bool countPass(const vector<Open> &frontier, const vector<Split> &previous, size_t g0, size_t g1,
+                   const vector<size_t> &offsets, vector<uint64_t> &table,
+                   bool first, bool compact, const vector<bool> &keep) {
+        ++passCount;
+        size_t columns = headers.size();
+        size_t buffer = bufferCodes(columns);
+        uint32_t k = classCount();
+        size_t labels = labelColumn();
+
+        vector<CodeReader> in(columns);
+        for (size_t c = 0; c < columns; ++c)
+            if (present[c] && !in[c].open(columnPath(c), buffer)) {
+                cerr << "Could not open " << columnPath(c) << "\n";
+                return false;
+            }
+        CodeReader nodeIn;
+        if (hasNodeFile && !nodeIn.open(nodePath(level - 1), buffer)) {
+            cerr << "Could not open " << nodePath(level - 1) << "\n";
+            return false;
+        }
+        CodeWriter nodeOut;
+        vector<CodeWriter> out(columns);
+        if (first) {
+            if (!nodeOut.open(nodePath(level), buffer)) {
+                cerr << "Could not create " << nodePath(level) << "\n";
+                return false;
+            }
+            for (size_t c = 0; c < columns && compact; ++c)
+                if (keep[c] && !out[c].open(columnPath(c, generation + 1), buffer)) {
+                    cerr << "Could not create " << columnPath(c, generation + 1) << "\n";
+                    return false;
+                }
+        }
+
+        // Where each of a node's candidate columns starts in its table
+        vector<vector<pair<uint32_t, size_t>>> layout(g1 - g0);
+        for (size_t i = g0; i < g1; ++i) {
+            size_t at = offsets[i - g0] + k;
+            for (uint32_t a : frontier[i].attributes) {
+                layout[i - g0].emplace_back(a, at);
+                at += values[a].size() * k;
+            }
+        }
+
+        vector<uint32_t> row(columns, 0);
+        for (uint64_t r = 0; r < rowCount; ++r) {
+            for (size_t c = 0; c < columns; ++c)
+                if (present[c]) row[c] = in[c].get();
+            uint32_t node = hasNodeFile ? nodeIn.get() : 0;
+            if (node != Closed && !previous.empty()) {
+                const Split &s = previous[node];
+                node = s.route[row[s.attribute]];
+            }
+            if (first) {
+                if (!compact) nodeOut.put(node);
+                else if (node != Closed) {
+                    nodeOut.put(node);
+                    for (size_t c = 0; c < columns; ++c)
+                        if (keep[c]) out[c].put(row[c]);
+                }
+            }
+            if (node == Closed || node < g0 || node >= g1) continue;
+            uint64_t *t = table.data() + offsets[node - g0];
+            uint32_t label = row[labels];
+            ++t[label];
+            for (auto const &[a, at] : layout[node - g0]) ++table[at + size_t(row[a]) * k + label];
+        }
+
+        bool ok = nodeIn.close();
+        for (size_t c = 0; c < columns; ++c) ok = in[c].close() && ok;
+        ok = nodeOut.close() && ok;
+        for (size_t c = 0; c < columns; ++c) ok = out[c].close() && ok;
+        if (!ok) cerr << "Error streaming the temporary files in " << dir << "\n";
+        return ok;
+    }
+
+    // Choose the split of an open node from its counts and create its children
+    Split split(NodeArena &arena, Open &o, const uint64_t *t, vector<Open> &next) {
+        uint32_t k = classCount();
+        double base = entropy(t, k, o.rows);
+        size_t best = 0;
+        double bestGain = -1.0;
+        const uint64_t *cells = t + k;
+        vector<const uint64_t*> starts;
+        for (size_t j = 0; j < o.attributes.size(); ++j) {
+            uint32_t a = o.attributes[j];
+            starts.push_back(cells);
+            double remainder = 0.0;
+            for (size_t v = 0; v < values[a].size(); ++v) {
+                const uint64_t *part = cells + v * k;
+                uint64_t n = accumulate(part, part + k, uint64_t(0));
+                if (n) remainder += double(n) / double(o.rows) * entropy(part, k, n);
+            }
+            double gain = base - remainder;
+            if (gain > bestGain + DecisionTree::GainTolerance) {
+                bestGain = gain;
+                best = j;
+            }
+            cells += values[a].size() * k;
+        }
+
+        uint32_t a = o.attributes[best];
+        const uint64_t *parts = starts[best];
+        vector<uint32_t> seen;
+        for (uint32_t v = 0; v < values[a].size(); ++v)
+            if (any_of(parts + size_t(v) * k, parts + size_t(v + 1) * k, [](uint64_t n) { return n > 0; }))
+                seen.push_back(v);
+        sort(seen.begin(), seen.end(),
+             [&](uint32_t x, uint32_t y) { return values[a][x] < values[a][y]; });
+
+        TreeNode *node = arena.make<TreeNode>(arena.intern(headers[a]));
+        *o.slot = node;
+        node->children = arena.makeArray<TreeEdge>(seen.size());
+        node->childCount = static_cast<uint32_t>(seen.size());
+        TrainingProgress::global().addSplit(seen.size());
+
+        vector<uint32_t> rest;
+        for (uint32_t b : o.attributes)
+            if (b != a) rest.push_back(b);
+        Split s{a, vector<uint32_t>(values[a].size(), Closed)};
+        for (size_t e = 0; e < seen.size(); ++e) {
+            uint32_t v = seen[e];
+            TreeEdge &edge = node->children[e];
+            edge.value = arena.intern(values[a][v]);
+            vector<uint64_t> classes(parts + size_t(v) * k, parts + size_t(v + 1) * k);
+            uint64_t rows = accumulate(classes.begin(), classes.end(), uint64_t(0));
+            s.route[v] = addNode(arena, &edge.child, rest, std::move(classes), rows, o.depth + 1, next);
+        }
+        return s;
+    }
+};
@@ -0,0 +1,105 @@
+// gen_data.cpp
+//
+// Writes a synthetic CSV dataset labelled by a planted decision tree (see synth_data.h).
+//
+//   gen_data [--rows N] [--cols N] [--cardinality K | K1,K2,...] [--classes N]
+//            [--noise P] [--skew S] [--depth D] [--seed N] [--out PATH] [--tree PATH]
+//
+// Row counts accept k/M/G suffixes (--rows 100M). Output goes to stdout unless --out is
+// given; --tree writes the planted tree so the true model is known.
+
+#include "synth_data.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+// "250", "10k", "100M", "2G"
+static uint64_t parseCount(const string &text) {
+    size_t used = 0;
+    uint64_t n = stoull(text, &used);
+    if (used < text.size()) {
+        switch (text[used]) {
+            case 'k': case 'K': n *= 1000ull; break;
+            case 'm': case 'M': n *= 1000000ull; break;
+            case 'g': case 'G': n *= 1000000000ull; break;
+            default: throw invalid_argument(text);
+        }
+    }
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    SynthSpec spec;
+    string outPath, treePath;
+    try {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            string value = argv[i + 1];
+            if (flag == "--rows") spec.rows = parseCount(value);
+            else if (flag == "--cols") spec.attributes = max<size_t>(1, stoul(value));
+            else if (flag == "--cardinality") {
+                spec.cardinality.clear();
+                string cell;
+                istringstream cells(value);
+                while (getline(cells, cell, ',')) spec.cardinality.push_back(stoul(cell));
+                if (spec.cardinality.size() == 1) {
+                    spec.defaultCardinality = spec.cardinality[0];
+                    spec.cardinality.clear();
+                }
+            }
+            else if (flag == "--classes") spec.classes = max<size_t>(1, stoul(value));
+            else if (flag == "--noise") spec.noise = clamp(stod(value), 0.0, 1.0);
+            else if (flag == "--skew") spec.skew = max(0.0, stod(value));
+            else if (flag == "--depth") spec.depth = stoul(value);
+            else if (flag == "--seed") spec.seed = stoull(value);
+            else if (flag == "--out") outPath = value;
+            else if (flag == "--tree") treePath = value;
+            else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
+            }
+        }
+    } catch (const exception &) {
+        cerr << "Invalid option value\n";
+        return 1;
+    }
+    if (argc % 2 == 0) {
+        cerr << "Usage: " << argv[0] << " [--rows N] [--cols N] [--cardinality K | K1,K2,...] [--classes N]"
+             << " [--noise P] [--skew S] [--depth D] [--seed N] [--out PATH] [--tree PATH]\n";
+        return 1;
+    }
+
+    SyntheticData data(spec);
+    if (data.plantedDepth() < spec.depth)
+        cerr << "Planted depth limited to " << data.plantedDepth() << "\n";
+
+    if (!treePath.empty()) {
+        ofstream tree(treePath, ios::trunc);
+        if (!tree.is_open()) {
+            cerr << "Error opening file: " << treePath << "\n";
+            return 1;
+        }
+        data.printTree(tree);
+    }
+
+    ios::sync_with_stdio(false);
+    ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error opening file: " << outPath << "\n";
+            return 1;
+        }
+    }
+    ostream &out = outPath.empty() ? cout : file;
+    data.writeCsv(out);
+    out.flush();
+    if (!out) {
+        cerr << "Write failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+// hoeffding_tree.h
+//
+// Online learner for data that keeps arriving: a Hoeffding tree (VFDT). Rows are learned
+// one at a time. Each active leaf keeps (attribute value x class) counts for its
+// candidate attributes, and every gracePeriod rows it compares the information gain of
+// its best and second-best attribute. It splits once the Hoeffding bound
+// eps = sqrt(R^2 ln(1/delta) / 2n), with R = log2(classes), says the best one is ahead
+// with probability 1 - delta, or once eps falls below tieThreshold and the choice no
+// longer matters. Learning a row costs one walk to a leaf plus one count per candidate
+// attribute. When the leaf statistics outgrow the memory budget, the leaves with the
+// fewest misclassified rows stop collecting them and keep predicting from their class
+// counts; what remains unbounded is one node per split branch and the value dictionaries.
+//
+// snapshot() converts the current tree into a DecisionTree, so it can be saved, served
+// and exported like a batch model.
+
+#pragma once
+
+#include "decision_tree.h"
+
+#include <deque>
+#include <numeric>
+
+struct HoeffdingOptions {
+    double delta = 1e-7;                    // chance that a split picks the wrong attribute
+    double tieThreshold = 0.05;             // split anyway once eps is this small
+    uint32_t gracePeriod = 200;             // rows a leaf learns between split attempts
+    size_t memoryBudget = size_t(64) << 20; // bytes of leaf statistics
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// HoeffdingTree: headers name the columns, label last, as in a DataSheet. Rows passed
+// to learn() and predict() hold one field per column in that order.
+// ————————————————————————————————————————————————————————————————————————————————
+class HoeffdingTree {
+public:
+    struct Stats {
+        uint64_t rows = 0;
+        size_t nodes = 0;
+        size_t leaves = 0;
+        size_t activeLeaves = 0;
+        size_t statsBytes = 0;
+    };
+
+    HoeffdingTree(vector<string> columns, HoeffdingOptions options = {})
+        : headers(std::move(columns)), options(options),
+          dictionary(headers.size()), values(headers.size())
+    {
+        vector<uint32_t> all(headers.size() - 1);
+        for (uint32_t a = 0; a < all.size(); ++a) all[a] = a;
+        nodes.emplace_back();
+        activate(0, std::move(all));
+    }
+
+    const vector<string>& getHeaders() const { return headers; }
+
+    void learn(const vector<string_view> &row) {
+        uint32_t label = encode(labelColumn(), row[labelColumn()]);
+        ++rowsSeen;
+
+        // Walk to the leaf; a value no internal node has seen grows a new leaf there
+        uint32_t at = 0;
+        while (nodes[at].attribute != Leaf) {
+            Node &node = nodes[at];
+            addClass(node.classes, label);
+            ++node.rows;
+            uint32_t value = encode(node.attribute, row[node.attribute]);
+            if (value >= node.children.size()) node.children.resize(value + 1, NoNode);
+            if (node.children[value] == NoNode) {
+                uint32_t child = static_cast<uint32_t>(nodes.size());
+                vector<uint32_t> candidates = remainingAfter(at);
+                nodes[at].children[value] = child;
+                nodes.emplace_back();
+                nodes[child].parent = at;
+                activate(child, std::move(candidates));
+            }
+            at = nodes[at].children[value];
+        }
+
+        Node &leaf = nodes[at];
+        addClass(leaf.classes, label);
+        ++leaf.rows;
+        if (!leaf.stats) return;
+        LeafStats &s = *leaf.stats;
+        addClass(s.classes, label);
+        ++s.rows;
+        for (size_t j = 0; j < s.attributes.size(); ++j) {
+            uint32_t value = encode(s.attributes[j], row[s.attributes[j]]);
+            auto &byValue = s.counts[j];
+            if (value >= byValue.size()) {
+                grow(s, (value + 1 - byValue.size()) * sizeof(vector<uint64_t>));
+                byValue.resize(value + 1);
+            }
+            if (label >= byValue[value].size()) grow(s, (label + 1 - byValue[value].size()) * sizeof(uint64_t));
+            addClass(byValue[value], label);
+        }
+        if (s.rows - s.rowsAtLastTry >= options.gracePeriod) trySplit(at);
+        if (statsBytes > options.memoryBudget) shrink();
+    }
+
+    // Majority label of the leaf the row reaches; an unseen value stops at the node that
+    // tests it. Empty before anything was learned.
+    string_view predict(const vector<string_view> &row) const {
+        uint32_t at = 0;
+        while (nodes[at].attribute != Leaf) {
+            const Node &node = nodes[at];
+            uint32_t value = lookup(node.attribute, row[node.attribute]);
+            if (value >= node.children.size() || node.children[value] == NoNode) break;
+            at = node.children[value];
+        }
+        return majority(nodes[at].classes);
+    }
+
+    Stats stats() const {
+        Stats st;
+        st.rows = rowsSeen;
+        st.nodes = nodes.size();
+        st.statsBytes = statsBytes;
+        for (auto const &n : nodes) {
+            st.leaves += n.attribute == Leaf;
+            st.activeLeaves += n.stats != nullptr;
+        }
+        return st;
+    }
+
+    // The current tree as a batch model (merged, compiled and flattened like any other);
+    // nullptr before any rows were learned, when the root has no label to predict
+    unique_ptr<DecisionTree> snapshot() const {
+        if (rowsSeen == 0) return nullptr;
+        return make_unique<DecisionTree>(headers, [this](NodeArena &arena) { return build(arena, 0); });
+    }
+
+private:
+    static constexpr uint32_t Leaf = UINT32_MAX;
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    struct LeafStats {
+        vector<uint32_t> attributes;            // candidate columns, in header order
+        vector<vector<vector<uint64_t>>> counts;// [candidate][value][class]
+        vector<uint64_t> classes;               // rows per class since the leaf was made
+        uint64_t rows = 0;
+        uint64_t rowsAtLastTry = 0;
+        size_t bytes = 0;
+    };
+
+    struct Node {
+        uint32_t attribute = Leaf;              // split column, Leaf for a leaf
+        uint32_t parent = NoNode;
+        vector<uint32_t> children;              // by value code, NoNode where unseen
+        vector<uint64_t> classes;               // rows per class that reached the node
+        uint64_t rows = 0;
+        unique_ptr<LeafStats> stats;            // null once split or deactivated
+    };
+
+    vector<string> headers;
+    HoeffdingOptions options;
+    vector<unordered_map<string_view, uint32_t>> dictionary;   // keys point into values
+    vector<deque<string>> values;                              // per column, by code
+    vector<Node> nodes;
+    uint64_t rowsSeen = 0;
+    size_t statsBytes = 0;
+
+    uint32_t labelColumn() const { return static_cast<uint32_t>(headers.size() - 1); }
+
+    uint32_t encode(uint32_t column, string_view value) {
+        auto it = dictionary[column].find(value);
+        if (it != dictionary[column].end()) return it->second;
+        values[column].emplace_back(value);
+        uint32_t code = static_cast<uint32_t>(values[column].size() - 1);
+        dictionary[column].emplace(values[column].back(), code);
+        return code;
+    }
+
+    uint32_t lookup(uint32_t column, string_view value) const {
+        auto it = dictionary[column].find(value);
+        return it == dictionary[column].end() ? NoNode : it->second;
+    }
+
+    static void addClass(vector<uint64_t> &classes, uint32_t label) {
+        if (label >= classes.size()) classes.resize(label + 1, 0);
+        ++classes[label];
+    }
+
+    // The smallest of tied labels, as in buildTree
+    string_view majority(const vector<uint64_t> &classes) const {
+        const deque<string> &labels = values[labelColumn()];
+        size_t best = classes.size();
+        for (size_t c = 0; c < classes.size(); ++c) {
+            if (!classes[c]) continue;
+            if (best == classes.size() || classes[c] > classes[best] ||
+                (classes[c] == classes[best] && labels[c] < labels[best])) best = c;
+        }
+        return best == classes.size() ? string_view{} : string_view(labels[best]);
+    }
+
+    static double entropy(const vector<uint64_t> &classes, uint64_t rows) {
+        double e = 0.0;
+        for (uint64_t n : classes) {
+            if (!n) continue;
+            double p = double(n) / double(rows);
+            e -= p * log2(p);
+        }
+        return e;
+    }
+
+    void grow(LeafStats &s, size_t bytes) {
+        s.bytes += bytes;
+        statsBytes += bytes;
+    }
+
+    void activate(uint32_t at, vector<uint32_t> candidates) {
+        auto s = make_unique<LeafStats>();
+        s->counts.resize(candidates.size());
+        s->attributes = std::move(candidates);
+        s->bytes = sizeof(LeafStats) + s->attributes.size() * (sizeof(uint32_t) + sizeof(vector<vector<uint64_t>>));
+        statsBytes += s->bytes;
+        nodes[at].stats = std::move(s);
+    }
+
+    void deactivate(uint32_t at) {
+        statsBytes -= nodes[at].stats->bytes;
+        nodes[at].stats.reset();
+    }
+
+    // Candidates for a new child of internal node `at`: every column not tested above it
+    vector<uint32_t> remainingAfter(uint32_t at) const {
+        vector<bool> used(headers.size() - 1, false);
+        for (uint32_t n = at; n != NoNode; n = nodes[n].parent) used[nodes[n].attribute] = true;
+        vector<uint32_t> rest;
+        for (uint32_t a = 0; a < used.size(); ++a)
+            if (!used[a]) rest.push_back(a);
+        return rest;
+    }
+
+    void trySplit(uint32_t at) {
+        LeafStats &s = *nodes[at].stats;
+        s.rowsAtLastTry = s.rows;
+        size_t labelsSeen = count_if(s.classes.begin(), s.classes.end(), [](uint64_t n) { return n > 0; });
+        if (labelsSeen <= 1 || s.attributes.empty()) return;
+
+        double base = entropy(s.classes, s.rows);
+        size_t best = 0;
+        double bestGain = -1.0, secondGain = 0.0;
+        for (size_t j = 0; j < s.attributes.size(); ++j) {
+            double remainder = 0.0;
+            for (auto const &part : s.counts[j]) {
+                uint64_t n = accumulate(part.begin(), part.end(), uint64_t(0));
+                if (n) remainder += double(n) / double(s.rows) * entropy(part, n);
+            }
+            double gain = base - remainder;
+            if (gain > bestGain + DecisionTree::GainTolerance) {
+                secondGain = max(secondGain, bestGain);
+                bestGain = gain;
+                best = j;
+            } else {
+                secondGain = max(secondGain, gain);
+            }
+        }
+        double range = log2(max<double>(2.0, static_cast<double>(values[labelColumn()].size())));
+        double eps = sqrt(range * range * log(1.0 / options.delta) / (2.0 * double(s.rows)));
+        if (bestGain <= 0.0 || (bestGain - secondGain <= eps && eps >= options.tieThreshold)) return;
+
+        // Split: each value seen here gets a leaf that starts from that value's class counts
+        uint32_t attribute = s.attributes[best];
+        vector<vector<uint64_t>> parts = std::move(s.counts[best]);
+        vector<uint32_t> rest;
+        for (uint32_t a : s.attributes)
+            if (a != attribute) rest.push_back(a);
+        deactivate(at);
+        nodes[at].attribute = attribute;
+        nodes[at].children.assign(parts.size(), NoNode);
+        for (uint32_t v = 0; v < parts.size(); ++v) {
+            uint64_t n = accumulate(parts[v].begin(), parts[v].end(), uint64_t(0));
+            if (!n) continue;
+            uint32_t child = static_cast<uint32_t>(nodes.size());
+            nodes[at].children[v] = child;
+            nodes.emplace_back();
+            nodes[child].parent = at;
+            nodes[child].classes = std::move(parts[v]);
+            nodes[child].rows = n;
+            activate(child, rest);
+        }
+    }
+
+    // Over budget: stop collecting at the leaves that misclassify the fewest rows, until
+    // the statistics are back under three quarters of the budget
+    void shrink() {
+        vector<pair<uint64_t, uint32_t>> ranked;
+        for (uint32_t i = 0; i < nodes.size(); ++i) {
+            if (!nodes[i].stats) continue;
+            const auto &c = nodes[i].classes;
+            uint64_t top = c.empty() ? 0 : *max_element(c.begin(), c.end());
+            ranked.emplace_back(nodes[i].rows - top, i);
+        }
+        sort(ranked.begin(), ranked.end());
+        for (auto const &[errors, i] : ranked) {
+            if (statsBytes <= options.memoryBudget / 4 * 3) break;
+            deactivate(i);
+        }
+    }
+
+    TreeNode* build(NodeArena &arena, uint32_t at) const {
+        const Node &node = nodes[at];
+        if (node.attribute == Leaf)
+            return arena.make<TreeNode>(LeafLabel{arena.intern(majority(node.classes))});
+        vector<uint32_t> present;
+        for (uint32_t v = 0; v < node.children.size(); ++v)
+            if (node.children[v] != NoNode) present.push_back(v);
+        const deque<string> &names = values[node.attribute];
+        sort(present.begin(), present.end(), [&](uint32_t x, uint32_t y) { return names[x] < names[y]; });
+
+        TreeNode *t = arena.make<TreeNode>(arena.intern(headers[node.attribute]));
+        t->children = arena.makeArray<TreeEdge>(present.size());
+        t->childCount = static_cast<uint32_t>(present.size());
+        for (size_t e = 0; e < present.size(); ++e)
+            t->children[e] = {arena.intern(names[present[e]]), build(arena, node.children[present[e]])};
+        return t;
+    }
+};
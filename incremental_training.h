@@ -0,0 +1,619 @@
+// incremental_training.h
+//
+// Retraining for datasets that grow by appended rows. The trainer keeps the rows as
+// dictionary codes, each internal node keeps its (attribute value x class) count table
+// and each leaf the ids of its rows. A node whose rows hold fewer codes than its table
+// has cells keeps no table and counts those rows again when it needs one. An append
+// routes only the new rows down the tree and adds them to the tables on their path. At
+// each node that gets new rows, the split is chosen again from the updated table. Where
+// the attribute stays, the rows go on to the children; a value seen there for the first
+// time gets a subtree built from its new rows alone. Where the attribute changes, or a
+// leaf stops being a leaf, that subtree is rebuilt from all of its rows.
+//
+// Splits follow buildTree: the same information gain, the first attribute wins ties,
+// a node becomes a leaf once it is pure or has at most one attribute left, and a majority
+// leaf takes the smallest of tied labels. Every count a node sees is the count a full
+// rebuild would see, summed in the same order, so the tree is the one a rebuild from all
+// rows grows. Everything lives in a state file next to the model.
+//
+//   dtree update <state> <rows.csv | -> <model.bin> [--delimiter C] [--rebuild]
+
+#pragma once
+
+#include "decision_tree.h"
+
+#include <numeric>
+
+// ————————————————————————————————————————————————————————————————————————————————
+// IncrementalTrainer: append() adds rows and updates the tree, load()/save() keep the
+// state between runs and snapshot() compiles the current tree into a DecisionTree.
+// ————————————————————————————————————————————————————————————————————————————————
+class IncrementalTrainer {
+public:
+    // What the last append() or rebuild() touched
+    struct UpdateStats {
+        uint64_t newRows = 0;
+        uint64_t totalRows = 0;
+        uint64_t nodesUpdated = 0;      // nodes whose counts took new rows
+        uint64_t subtreesRebuilt = 0;
+        uint64_t rowsRebuilt = 0;       // rows in those subtrees
+    };
+
+    explicit IncrementalTrainer(char delimiter = ',')
+        : delimiter(delimiter) {}
+
+    IncrementalTrainer(const IncrementalTrainer&) = delete;
+    IncrementalTrainer& operator=(const IncrementalTrainer&) = delete;
+
+    bool empty() const { return rowCount() == 0; }
+    uint64_t rowCount() const { return headers.empty() ? 0 : codes.size() / headers.size(); }
+    const UpdateStats& lastUpdate() const { return last; }
+
+    // Read a header line and rows, append the rows and update the tree. The header must
+    // match the stored one. On false (reported on cerr) the trainer must not be saved.
+    bool append(istream &in) {
+        PhaseTimer timer(Metrics::Phase::Train);
+        AllocScope scope(AllocSubsystem::TrainingScratch);
+        string line;
+        if (!getline(in, line)) {
+            cerr << "Input is empty, expected a header line\n";
+            return false;
+        }
+        vector<string> names;
+        DataSheet::splitDelimiter(line, names, delimiter);
+        if (headers.empty()) {
+            if (names.size() < 2) {
+                cerr << "Need at least one attribute column and a label column\n";
+                return false;
+            }
+            headers = names;
+            dictionary.assign(headers.size(), {});
+            values.assign(headers.size(), {});
+        } else if (names != headers) {
+            cerr << "Header does not match the columns of the stored rows\n";
+            return false;
+        }
+
+        size_t columns = headers.size();
+        uint64_t first = rowCount();
+        vector<string> fields;
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            DataSheet::splitDelimiter(line, fields, delimiter);
+            if (fields.size() != columns) {
+                cerr << "Row " << rowCount() - first + 1 << " has " << fields.size()
+                     << " fields, expected " << columns << "\n";
+                return false;
+            }
+            for (size_t c = 0; c < columns; ++c) codes.push_back(encode(c, fields[c]));
+        }
+        if (rowCount() >= NoNode) {
+            cerr << "Incremental training supports at most " << NoNode - 1 << " rows\n";
+            return false;
+        }
+
+        last = {};
+        last.newRows = rowCount() - first;
+        last.totalRows = rowCount();
+        vector<uint32_t> added(last.newRows);
+        iota(added.begin(), added.end(), static_cast<uint32_t>(first));
+        if (added.empty()) return true;
+        if (root) {
+            update(*root, std::move(added));
+            return true;
+        }
+        last.subtreesRebuilt = 1;
+        last.rowsRebuilt = added.size();
+        root = build(std::move(added), allAttributes());
+        return true;
+    }
+
+    // Regrow the whole tree from the stored rows
+    void rebuild() {
+        PhaseTimer timer(Metrics::Phase::Train);
+        AllocScope scope(AllocSubsystem::TrainingScratch);
+        last = {};
+        last.totalRows = rowCount();
+        root.reset();
+        if (empty()) return;
+        vector<uint32_t> all(rowCount());
+        iota(all.begin(), all.end(), 0u);
+        last.subtreesRebuilt = 1;
+        last.rowsRebuilt = all.size();
+        root = build(std::move(all), allAttributes());
+    }
+
+    // The current tree as a batch model; nullptr before any rows were added
+    unique_ptr<DecisionTree> snapshot() const {
+        if (!root) return nullptr;
+        return make_unique<DecisionTree>(headers, [this](NodeArena &arena) { return emit(arena, *root); });
+    }
+
+    bool save(const string &path) const {
+        vector<unsigned char> out(Magic, Magic + sizeof Magic);
+        put32(out, Version);
+        put32(out, static_cast<uint32_t>(headers.size()));
+        for (size_t c = 0; c < headers.size(); ++c) {
+            putString(out, headers[c]);
+            put32(out, static_cast<uint32_t>(values[c].size()));
+            for (auto const &v : values[c]) putString(out, v);
+        }
+        put64(out, codes.size());
+        putItems(out, codes);
+        put32(out, root ? 1 : 0);
+        if (root) putNode(out, *root);
+
+        // Written aside and renamed over, like a model, so a crash keeps the old state
+        string tmpPath = path + ".tmp";
+        ofstream file(tmpPath, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error opening state file for writing: " << tmpPath << "\n";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(out.data()), static_cast<streamsize>(out.size()));
+        file.close();
+        if (!file || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            cerr << "Error writing state file: " << path << "\n";
+            remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool load(const string &path) {
+        PhaseTimer timer(Metrics::Phase::Load);
+        AllocScope scope(AllocSubsystem::Loader);
+        ifstream file(path, ios::binary);
+        if (!file.is_open()) {
+            cerr << "Error opening state file: " << path << "\n";
+            return false;
+        }
+        file.seekg(0, ios::end);
+        vector<unsigned char> in(static_cast<size_t>(max<streamoff>(0, file.tellg())));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(in.data()), static_cast<streamsize>(in.size()));
+        Reader r{in.data(), in.data() + in.size()};
+        if (!parse(r) || r.p != r.end) {
+            cerr << "Not a valid state file: " << path << "\n";
+            headers.clear();
+            dictionary.clear();
+            values.clear();
+            codes.clear();
+            root.reset();
+            return false;
+        }
+        return true;
+    }
+
+    // True when the file starts with the state magic
+    static bool isStateFile(const string &path) {
+        char magic[sizeof Magic] = {};
+        ifstream file(path, ios::binary);
+        return file.read(magic, sizeof magic) && memcmp(magic, Magic, sizeof Magic) == 0;
+    }
+
+private:
+    static constexpr char Magic[8] = {'D', 'T', 'S', 'T', 'A', 'T', 'E', '\0'};
+    static constexpr uint32_t Version = 1;
+    static constexpr uint32_t Leaf = UINT32_MAX;
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    struct Node {
+        uint32_t attribute = Leaf;                  // split column, Leaf for a leaf
+        vector<uint32_t> candidates;                // columns still in play, in header order
+        vector<uint32_t> classes;                   // rows per label code
+        uint64_t rows = 0;
+        vector<uint32_t> widths;                    // internal: values per candidate in the table
+        uint32_t labels = 0;                        // internal: classes per value in the table
+        vector<uint32_t> table;                     // internal: [candidate][value][class], or empty
+        vector<unique_ptr<Node>> children;          // internal: by value code
+        vector<uint32_t> rowIds;                    // leaf: its rows
+    };
+
+    char delimiter;
+    vector<string> headers;
+    vector<unordered_map<string, uint32_t>> dictionary;
+    vector<vector<string>> values;                  // per column, by code
+    vector<uint32_t> codes;                         // row-major, headers.size() per row
+    unique_ptr<Node> root;
+    UpdateStats last;
+
+    size_t labelColumn() const { return headers.size() - 1; }
+    uint32_t code(uint32_t row, size_t column) const { return codes[size_t(row) * headers.size() + column]; }
+    uint32_t label(uint32_t row) const { return code(row, labelColumn()); }
+
+    uint32_t encode(size_t column, const string &value) {
+        auto [it, added] = dictionary[column].try_emplace(value, static_cast<uint32_t>(values[column].size()));
+        if (added) values[column].push_back(value);
+        return it->second;
+    }
+
+    vector<uint32_t> allAttributes() const {
+        vector<uint32_t> all(labelColumn());
+        iota(all.begin(), all.end(), 0u);
+        return all;
+    }
+
+    static void add(vector<uint32_t> &counts, uint32_t at) {
+        if (at >= counts.size()) counts.resize(at + 1, 0);
+        ++counts[at];
+    }
+
+    static bool isLeaf(const Node &n) {
+        size_t labelsSeen = count_if(n.classes.begin(), n.classes.end(), [](uint32_t c) { return c > 0; });
+        return labelsSeen <= 1 || n.candidates.size() <= 1;
+    }
+
+    static double entropy(const uint32_t *classes, size_t k, uint64_t rows) {
+        double e = 0.0;
+        for (size_t c = 0; c < k; ++c) {
+            if (!classes[c]) continue;
+            double p = double(classes[c]) / double(rows);
+            e -= p * log2(p);
+        }
+        return e;
+    }
+
+    // Index into n.candidates of the attribute buildTree would split on. Cells a table has
+    // no room for yet are zero counts, which the sums skip, so only the counts matter.
+    static size_t bestCandidate(const Node &n) {
+        double base = entropy(n.classes.data(), n.classes.size(), n.rows);
+        size_t best = 0;
+        double bestGain = -1.0;
+        const uint32_t *cells = n.table.data();
+        for (size_t j = 0; j < n.candidates.size(); ++j) {
+            double remainder = 0.0;
+            for (uint32_t v = 0; v < n.widths[j]; ++v, cells += n.labels) {
+                uint64_t count = accumulate(cells, cells + n.labels, uint64_t(0));
+                if (count) remainder += double(count) / double(n.rows) * entropy(cells, n.labels, count);
+            }
+            double gain = base - remainder;
+            if (gain > bestGain + DecisionTree::GainTolerance) {
+                bestGain = gain;
+                best = j;
+            }
+        }
+        return best;
+    }
+
+    // Give n.table a cell for every value and class in the dictionaries, keeping its counts.
+    // Only values or labels never seen before make a node lay its table out again.
+    void layout(Node &n) const {
+        auto k = static_cast<uint32_t>(values[labelColumn()].size());
+        bool fits = n.labels == k && n.widths.size() == n.candidates.size();
+        for (size_t j = 0; fits && j < n.candidates.size(); ++j) fits = n.widths[j] == values[n.candidates[j]].size();
+        if (fits) return;
+
+        vector<uint32_t> widths;
+        size_t cells = 0;
+        for (uint32_t a : n.candidates) {
+            widths.push_back(static_cast<uint32_t>(values[a].size()));
+            cells += size_t(widths.back()) * k;
+        }
+        vector<uint32_t> table(cells, 0);
+        size_t from = 0, to = 0;
+        for (size_t j = 0; j < n.widths.size(); ++j) {
+            for (uint32_t v = 0; v < n.widths[j]; ++v)
+                copy_n(n.table.begin() + from + size_t(v) * n.labels, n.labels, table.begin() + to + size_t(v) * k);
+            from += size_t(n.widths[j]) * n.labels;
+            to += size_t(widths[j]) * k;
+        }
+        n.widths = std::move(widths);
+        n.labels = k;
+        n.table = std::move(table);
+    }
+
+    // Row ids are u32, so no count outgrows its u32 cell
+    void count(Node &n, const vector<uint32_t> &rows) const {
+        layout(n);
+        vector<size_t> starts;
+        size_t at = 0;
+        for (uint32_t w : n.widths) {
+            starts.push_back(at);
+            at += size_t(w) * n.labels;
+        }
+        for (uint32_t r : rows) {
+            uint32_t y = label(r);
+            for (size_t j = 0; j < n.candidates.size(); ++j)
+                ++n.table[starts[j] + size_t(code(r, n.candidates[j])) * n.labels + y];
+        }
+    }
+
+    // A table is worth keeping when recounting the node's rows would touch at least as
+    // many codes as the table has cells
+    bool keepsTable(const Node &n) const {
+        size_t cells = 0;
+        for (uint32_t a : n.candidates) cells += values[a].size();
+        return n.rows * n.candidates.size() >= cells * values[labelColumn()].size();
+    }
+
+    static void dropTable(Node &n) {
+        n.widths.clear();
+        n.labels = 0;
+        n.table.clear();
+        n.table.shrink_to_fit();
+    }
+
+    // Rows of the candidate split, grouped by value code
+    vector<vector<uint32_t>> partition(const Node &n, const vector<uint32_t> &rows) const {
+        vector<vector<uint32_t>> parts(values[n.attribute].size());
+        for (uint32_t r : rows) parts[code(r, n.attribute)].push_back(r);
+        return parts;
+    }
+
+    vector<uint32_t> without(const vector<uint32_t> &candidates, uint32_t attribute) const {
+        vector<uint32_t> rest;
+        for (uint32_t a : candidates)
+            if (a != attribute) rest.push_back(a);
+        return rest;
+    }
+
+    unique_ptr<Node> build(vector<uint32_t> rows, vector<uint32_t> candidates) {
+        auto n = make_unique<Node>();
+        n->candidates = std::move(candidates);
+        n->rows = rows.size();
+        for (uint32_t r : rows) add(n->classes, label(r));
+        if (isLeaf(*n)) {
+            n->rowIds = std::move(rows);
+            return n;
+        }
+        split(*n, rows);
+        return n;
+    }
+
+    // Make n an internal node on its best attribute, children built from `rows`
+    void split(Node &n, const vector<uint32_t> &rows) {
+        count(n, rows);
+        n.attribute = n.candidates[bestCandidate(n)];
+        vector<uint32_t> rest = without(n.candidates, n.attribute);
+        auto parts = partition(n, rows);
+        n.children.resize(parts.size());
+        for (size_t v = 0; v < parts.size(); ++v)
+            if (!parts[v].empty()) n.children[v] = build(std::move(parts[v]), rest);
+        if (!keepsTable(n)) dropTable(n);
+    }
+
+    void collectRows(Node &n, vector<uint32_t> &out) const {
+        out.insert(out.end(), n.rowIds.begin(), n.rowIds.end());
+        for (auto &child : n.children)
+            if (child) collectRows(*child, out);
+    }
+
+    // Throw the subtree away and grow it again from all of its rows plus `added`
+    void regrow(Node &n, vector<uint32_t> added) {
+        vector<uint32_t> rows;
+        rows.reserve(n.rows);
+        collectRows(n, rows);
+        rows.insert(rows.end(), added.begin(), added.end());
+        ++last.subtreesRebuilt;
+        last.rowsRebuilt += rows.size();
+        n.attribute = Leaf;
+        dropTable(n);
+        n.children.clear();
+        n.rowIds.clear();
+        n.classes.clear();
+        n.rows = rows.size();
+        for (uint32_t r : rows) add(n.classes, label(r));
+        if (isLeaf(n)) n.rowIds = std::move(rows);
+        else split(n, rows);
+    }
+
+    void update(Node &n, vector<uint32_t> added) {
+        ++last.nodesUpdated;
+        n.rows += added.size();
+        for (uint32_t r : added) add(n.classes, label(r));
+        if (n.attribute == Leaf) {
+            if (isLeaf(n)) n.rowIds.insert(n.rowIds.end(), added.begin(), added.end());
+            else regrow(n, std::move(added));
+            return;
+        }
+
+        if (n.table.empty()) {
+            vector<uint32_t> old;
+            collectRows(n, old);
+            count(n, old);
+        }
+        count(n, added);
+        if (n.candidates[bestCandidate(n)] != n.attribute) {
+            regrow(n, std::move(added));
+            return;
+        }
+        if (!keepsTable(n)) dropTable(n);
+        vector<uint32_t> rest = without(n.candidates, n.attribute);
+        auto parts = partition(n, added);
+        if (n.children.size() < parts.size()) n.children.resize(parts.size());
+        for (size_t v = 0; v < parts.size(); ++v) {
+            if (parts[v].empty()) continue;
+            if (n.children[v]) update(*n.children[v], std::move(parts[v]));
+            else n.children[v] = build(std::move(parts[v]), rest);
+        }
+    }
+
+    // Majority label, the smallest one on ties as in buildTree
+    string_view majority(const Node &n) const {
+        const vector<string> &labels = values[labelColumn()];
+        size_t best = 0;
+        for (size_t c = 1; c < n.classes.size(); ++c)
+            if (n.classes[c] > n.classes[best] || (n.classes[c] == n.classes[best] && labels[c] < labels[best]))
+                best = c;
+        return labels[best];
+    }
+
+    TreeNode* emit(NodeArena &arena, const Node &n) const {
+        if (n.attribute == Leaf) return arena.make<TreeNode>(LeafLabel{arena.intern(majority(n))});
+        vector<uint32_t> present;
+        for (uint32_t v = 0; v < n.children.size(); ++v)
+            if (n.children[v]) present.push_back(v);
+        const vector<string> &names = values[n.attribute];
+        sort(present.begin(), present.end(), [&](uint32_t x, uint32_t y) { return names[x] < names[y]; });
+
+        TreeNode *t = arena.make<TreeNode>(arena.intern(headers[n.attribute]));
+        t->children = arena.makeArray<TreeEdge>(present.size());
+        t->childCount = static_cast<uint32_t>(present.size());
+        for (size_t e = 0; e < present.size(); ++e)
+            t->children[e] = {arena.intern(names[present[e]]), emit(arena, *n.children[present[e]])};
+        return t;
+    }
+
+    // ────────────────────────────────────────────────────────────────────────────────
+    // State file: little-endian u32/u64 fields, strings as u32 length plus bytes, nodes in
+    // pre-order. Arrays are a u32 length and their items, stored in one go.
+    static void put32(vector<unsigned char> &out, uint32_t v) {
+        out.resize(out.size() + 4);
+        ModelFile::store32(out, out.size() - 4, v);
+    }
+    static void put64(vector<unsigned char> &out, uint64_t v) {
+        out.resize(out.size() + 8);
+        ModelFile::store64(out, out.size() - 8, v);
+    }
+    static void putString(vector<unsigned char> &out, const string &s) {
+        put32(out, static_cast<uint32_t>(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+    template <class T>
+    static void putItems(vector<unsigned char> &out, const vector<T> &items) {
+        size_t at = out.size();
+        out.resize(at + items.size() * sizeof(T));
+        for (size_t i = 0; i < items.size(); ++i, at += sizeof(T)) {
+            if constexpr (sizeof(T) == 8) ModelFile::store64(out, at, items[i]);
+            else ModelFile::store32(out, at, items[i]);
+        }
+    }
+    template <class T>
+    static void putArray(vector<unsigned char> &out, const vector<T> &items) {
+        put32(out, static_cast<uint32_t>(items.size()));
+        putItems(out, items);
+    }
+
+    void putNode(vector<unsigned char> &out, const Node &n) const {
+        put32(out, n.attribute);
+        putArray(out, n.candidates);
+        putArray(out, n.classes);
+        put64(out, n.rows);
+        if (n.attribute == Leaf) {
+            putArray(out, n.rowIds);
+            return;
+        }
+        put32(out, n.labels);
+        putArray(out, n.widths);
+        put64(out, n.table.size());
+        putItems(out, n.table);
+        put32(out, static_cast<uint32_t>(n.children.size()));
+        for (auto const &child : n.children) {
+            put32(out, child ? 1 : 0);
+            if (child) putNode(out, *child);
+        }
+    }
+
+    struct Reader {
+        const unsigned char *p, *end;
+        bool get32(uint32_t &v) {
+            if (end - p < 4) return false;
+            v = ModelFile::load32(p);
+            p += 4;
+            return true;
+        }
+        bool get64(uint64_t &v) {
+            if (end - p < 8) return false;
+            v = ModelFile::load64(p);
+            p += 8;
+            return true;
+        }
+        bool getString(string &s) {
+            uint32_t n;
+            if (!get32(n) || static_cast<size_t>(end - p) < n) return false;
+            s.assign(reinterpret_cast<const char*>(p), n);
+            p += n;
+            return true;
+        }
+        // Item counts are checked against the bytes left before anything is allocated
+        template <class T>
+        bool getItems(vector<T> &items, uint64_t n) {
+            if (static_cast<size_t>(end - p) / sizeof(T) < n) return false;
+            items.resize(n);
+            for (auto &item : items) {
+                if constexpr (sizeof(T) == 8) item = ModelFile::load64(p);
+                else item = ModelFile::load32(p);
+                p += sizeof(T);
+            }
+            return true;
+        }
+        template <class T>
+        bool getArray(vector<T> &items) {
+            uint32_t n;
+            return get32(n) && getItems(items, n);
+        }
+    };
+
+    bool parse(Reader &r) {
+        if (static_cast<size_t>(r.end - r.p) < sizeof Magic || memcmp(r.p, Magic, sizeof Magic) != 0) return false;
+        r.p += sizeof Magic;
+        uint32_t version, columns;
+        if (!r.get32(version) || version != Version || !r.get32(columns) || columns < 2 || columns > size_t(r.end - r.p))
+            return false;
+        headers.assign(columns, {});
+        dictionary.assign(columns, {});
+        values.assign(columns, {});
+        for (size_t c = 0; c < columns; ++c) {
+            uint32_t count;
+            if (!r.getString(headers[c]) || !r.get32(count) || count > size_t(r.end - r.p) / 4) return false;
+            values[c].resize(count);
+            for (uint32_t v = 0; v < count; ++v) {
+                if (!r.getString(values[c][v]) || !dictionary[c].emplace(values[c][v], v).second) return false;
+            }
+        }
+        uint64_t codeCount;
+        if (!r.get64(codeCount) || codeCount % columns || !r.getItems(codes, codeCount)) return false;
+        for (size_t i = 0; i < codes.size(); ++i)
+            if (codes[i] >= values[i % columns].size()) return false;
+        uint32_t hasRoot;
+        if (!r.get32(hasRoot) || hasRoot > 1) return false;
+        root.reset();
+        if (hasRoot) {
+            root = make_unique<Node>();
+            if (!parseNode(r, *root, allAttributes(), 0)) return false;
+        }
+        return true;
+    }
+
+    bool parseNode(Reader &r, Node &n, const vector<uint32_t> &expected, uint32_t depth) {
+        if (depth > headers.size()) return false;
+        size_t classCount = values[labelColumn()].size();
+        if (!r.get32(n.attribute) || !r.getArray(n.candidates) || n.candidates != expected ||
+            !r.getArray(n.classes) || n.classes.size() > classCount || !r.get64(n.rows) ||
+            accumulate(n.classes.begin(), n.classes.end(), uint64_t(0)) != n.rows)
+            return false;
+        if (n.attribute == Leaf) {
+            if (!r.getArray(n.rowIds)) return false;
+            for (uint32_t id : n.rowIds)
+                if (id >= rowCount()) return false;
+            return n.rowIds.size() == n.rows;
+        }
+        if (find(n.candidates.begin(), n.candidates.end(), n.attribute) == n.candidates.end()) return false;
+        uint64_t cells;
+        if (!r.get32(n.labels) || n.labels > classCount || !r.getArray(n.widths) ||
+            (!n.widths.empty() && n.widths.size() != n.candidates.size()) || !r.get64(cells) ||
+            !r.getItems(n.table, cells))
+            return false;
+        uint64_t expectedCells = 0;
+        for (size_t j = 0; j < n.widths.size(); ++j) {
+            if (n.widths[j] > values[n.candidates[j]].size()) return false;
+            expectedCells += uint64_t(n.widths[j]) * n.labels;
+        }
+        if (cells != expectedCells) return false;
+        uint32_t childCount;
+        if (!r.get32(childCount) || childCount > values[n.attribute].size()) return false;
+        n.children.resize(childCount);
+        vector<uint32_t> rest = without(n.candidates, n.attribute);
+        uint64_t below = 0;
+        for (auto &child : n.children) {
+            uint32_t present;
+            if (!r.get32(present) || present > 1) return false;
+            if (!present) continue;
+            child = make_unique<Node>();
+            if (!parseNode(r, *child, rest, depth + 1)) return false;
+            below += child->rows;
+        }
+        return below == n.rows;
+    }
+};
@@ -0,0 +1,130 @@
+// model_slot.h
+//
+// Holds the active model behind an atomically swapped pointer with epoch-based
+// reclamation, so a new model can be published while predictions keep running.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ————————————————————————————————————————————————————————————————————————————————
+// ModelSlot<T>: RCU-style holder. Readers pin the current epoch in one of a fixed set of
+// cache-line-sized slots and then load the pointer; they never block or take a lock.
+// swap() publishes the new model, advances the epoch and retires the old one, which is
+// deleted once every pinned reader has moved past the epoch it was retired in.
+// ————————————————————————————————————————————————————————————————————————————————
+template <class T>
+class ModelSlot {
+public:
+    static constexpr size_t MaxReaders = 64;
+
+    explicit ModelSlot(std::unique_ptr<T> initial)
+        : current(initial.release()) {}
+
+    ModelSlot(const ModelSlot&) = delete;
+    ModelSlot& operator=(const ModelSlot&) = delete;
+
+    // Callers must make sure no reader is still inside a ReadGuard
+    ~ModelSlot() {
+        delete current.load();
+        for (auto &r : retired) delete r.model;
+    }
+
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard &&other) noexcept
+            : slot(other.slot), model(other.model) {
+            other.slot = nullptr;
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard() {
+            if (slot) slot->store(0, std::memory_order_release);
+        }
+
+        const T* get() const { return model; }
+        const T* operator->() const { return model; }
+        const T& operator*() const { return *model; }
+
+    private:
+        friend class ModelSlot;
+        ReadGuard(std::atomic<uint64_t> *slot, const T *model)
+            : slot(slot), model(model) {}
+
+        std::atomic<uint64_t> *slot;
+        const T *model;
+    };
+
+    // Pin the current epoch and return the model it sees. The model stays alive until
+    // the guard is destroyed, even if swap() publishes a new one in the meantime.
+    ReadGuard read() {
+        thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        while (true) {
+            uint64_t e = epoch.load();
+            for (size_t i = 0; i < MaxReaders; ++i) {
+                auto &slot = readers[(hint + i) % MaxReaders].epoch;
+                uint64_t expected = 0;
+                if (slot.compare_exchange_strong(expected, e)) {
+                    hint = (hint + i) % MaxReaders;
+                    return ReadGuard(&slot, current.load());
+                }
+            }
+            std::this_thread::yield();          // more than MaxReaders concurrent readers
+        }
+    }
+
+    // Publish next; the previous model is freed as soon as no reader can still see it.
+    // Returns how many retired models are still waiting for readers to leave.
+    size_t swap(std::unique_ptr<T> next) {
+        std::lock_guard<std::mutex> lock(writer);
+        T *old = current.exchange(next.release());
+        uint64_t retiredAt = epoch.fetch_add(1) + 1;
+        retired.push_back({old, retiredAt});
+        return reclaimLocked();
+    }
+
+    // Free retired models that no pinned reader can reference; returns how many remain
+    size_t reclaim() {
+        std::lock_guard<std::mutex> lock(writer);
+        return reclaimLocked();
+    }
+
+private:
+    struct alignas(64) Reader {
+        std::atomic<uint64_t> epoch{0};     // 0 = free, otherwise the epoch pinned at entry
+    };
+    struct Retired {
+        T *model;
+        uint64_t epoch;                     // first epoch in which the model was unreachable
+    };
+
+    std::atomic<T*> current;
+    std::atomic<uint64_t> epoch{1};
+    std::array<Reader, MaxReaders> readers;
+    std::mutex writer;
+    std::vector<Retired> retired;           // guarded by writer
+
+    size_t reclaimLocked() {
+        // A reader pinned at epoch e loaded the pointer after that epoch began, so it
+        // can only hold models retired after e.
+        uint64_t oldest = UINT64_MAX;
+        for (auto &r : readers) {
+            uint64_t e = r.epoch.load();
+            if (e != 0 && e < oldest) oldest = e;
+        }
+        size_t kept = 0;
+        for (auto &r : retired) {
+            if (r.epoch <= oldest) delete r.model;
+            else retired[kept++] = r;
+        }
+        retired.resize(kept);
+        return kept;
+    }
+};
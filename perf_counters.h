@@ -0,0 +1,185 @@
+// perf_counters.h
+//
+// Optional hardware counters (cycles, instructions, L1D and LLC read misses, branch
+// misses) via perf_event_open, accumulated per region around the hot loops. Disabled
+// unless PerfCounters::global().enable() succeeds; in containers or with a restrictive
+// perf_event_paranoid it reports why and every scope stays a single relaxed load.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ————————————————————————————————————————————————————————————————————————————————
+// PerfCounters: one counter group per thread (counting that thread only, user space
+// only), opened lazily; region totals are relaxed atomics shared by all threads.
+// ————————————————————————————————————————————————————————————————————————————————
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses, EventCount };
+    enum Region { SplitSearch, Partition, Predict, RegionCount };
+
+    // Counter values; UINT64_MAX marks an event the CPU or kernel does not provide
+    struct Sample {
+        std::array<uint64_t, EventCount> value{};
+
+        bool has(Event e) const { return value[e] != UINT64_MAX; }
+    };
+
+    static PerfCounters& global() {
+        static PerfCounters instance;
+        return instance;
+    }
+
+    // Try to open counters on the calling thread; on failure unavailableReason() says why
+    bool enable() {
+        Sample probe;
+        if (!read(probe)) {
+            reason = threadGroup().error;
+            return false;
+        }
+        enabled.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    const std::string& unavailableReason() const { return reason; }     // set by a failed enable()
+
+    static const char* eventName(Event e) {
+        static const char *names[] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+        return names[e];
+    }
+    static const char* regionName(Region r) {
+        static const char *names[] = {"split_search", "partition", "predict"};
+        return names[r];
+    }
+
+    // Current counts of the calling thread's group, scaled if the group was multiplexed
+    bool read(Sample &out) {
+        ThreadGroup &g = threadGroup();
+        if (g.leader < 0) return false;
+        uint64_t buf[3 + EventCount] = {};      // nr, time_enabled, time_running, values
+        if (::read(g.leader, buf, sizeof buf) < static_cast<ssize_t>(3 * sizeof(uint64_t))) return false;
+        double scale = buf[2] ? static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 1.0;
+        for (int e = 0; e < EventCount; ++e) {
+            int slot = g.slot[e];
+            out.value[e] = slot < 0 ? UINT64_MAX : static_cast<uint64_t>(static_cast<double>(buf[3 + slot]) * scale);
+        }
+        return true;
+    }
+
+    void add(Region r, const Sample &begin, const Sample &end) {
+        auto &t = totals[r];
+        t.entries.fetch_add(1, std::memory_order_relaxed);
+        for (int e = 0; e < EventCount; ++e) {
+            if (!end.has(static_cast<Event>(e))) t.missing[e].store(true, std::memory_order_relaxed);
+            else t.value[e].fetch_add(end.value[e] - begin.value[e], std::memory_order_relaxed);
+        }
+    }
+
+    Sample total(Region r) const {
+        Sample s;
+        for (int e = 0; e < EventCount; ++e) {
+            s.value[e] = totals[r].missing[e].load(std::memory_order_relaxed)
+                ? UINT64_MAX : totals[r].value[e].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    uint64_t entries(Region r) const { return totals[r].entries.load(std::memory_order_relaxed); }
+
+private:
+    struct ThreadGroup {
+        int leader = -1;
+        std::array<int, EventCount> fd{};
+        std::array<int, EventCount> slot{};     // position in the group read, -1 if absent
+        std::string error;
+        ThreadGroup() { fd.fill(-1); slot.fill(-1); }
+        ~ThreadGroup() { for (int f : fd) if (f >= 0) close(f); }
+    };
+    struct Totals {
+        std::atomic<uint64_t> entries{0};
+        std::array<std::atomic<uint64_t>, EventCount> value{};
+        std::array<std::atomic<bool>, EventCount> missing{};
+    };
+
+    std::atomic<bool> enabled{false};
+    std::array<Totals, RegionCount> totals{};
+    std::string reason;
+
+    static int openEvent(uint32_t type, uint64_t config, int groupFd) {
+        perf_event_attr attr{};
+        attr.size = sizeof attr;
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+
+    ThreadGroup& threadGroup() {
+        thread_local ThreadGroup group;
+        thread_local bool tried = false;
+        if (tried) return group;
+        tried = true;
+
+        static const std::pair<uint32_t, uint64_t> events[EventCount] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                 | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                 | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        // Cycles lead the group; the other events are optional and simply left out
+        group.fd[Cycles] = openEvent(events[Cycles].first, events[Cycles].second, -1);
+        if (group.fd[Cycles] < 0) {
+            group.error = std::string("perf_event_open: ") + std::strerror(errno);
+            std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+            int level;
+            if (paranoid >> level) group.error += " (perf_event_paranoid=" + std::to_string(level) + ")";
+            return group;
+        }
+        group.leader = group.fd[Cycles];
+        int slots = 0;
+        group.slot[Cycles] = slots++;
+        for (int e = Instructions; e < EventCount; ++e) {
+            group.fd[e] = openEvent(events[e].first, events[e].second, group.leader);
+            if (group.fd[e] >= 0) group.slot[e] = slots++;
+        }
+        ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return group;
+    }
+};
+
+// RAII: adds the counters spent in the scope to a region when counters are enabled
+class PerfScope {
+public:
+    explicit PerfScope(PerfCounters::Region region)
+        : region(region), active(PerfCounters::global().isEnabled()) {
+        if (active) active = PerfCounters::global().read(begin);
+    }
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+    ~PerfScope() {
+        PerfCounters::Sample end;
+        if (active && PerfCounters::global().read(end)) PerfCounters::global().add(region, begin, end);
+    }
+
+private:
+    PerfCounters::Region region;
+    bool active;
+    PerfCounters::Sample begin;
+};
@@ -0,0 +1,365 @@
+// perf_gate.cpp
+//
+// Performance regression gate: runs tree_bench several times, takes the median of every
+// metric across runs and compares it with a checked-in baseline. Exits 1 when any
+// benchmark got slower, allocates more, or a dataset's peak RSS grew beyond tolerance.
+//
+//   perf_gate [--bench PATH] [--baseline PATH] [--data DIR] [--runs N] [--min-time S]
+//             [--time-tolerance F] [--alloc-tolerance F] [--rss-tolerance F] [--update]
+//
+// Tolerances are relative (0.15 = 15%). The baseline is host-specific: timings depend on
+// the CPU, and peak RSS on the allocator, libc and kernel, so --update rewrites it from
+// this run on the machine that runs the gate and records that machine's hostname.
+// A baseline taken elsewhere is only a starting point.
+// Exit status: 0 pass, 1 regression, 2 the benchmark could not be run or read.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct GateOptions {
+    string bench = "./tree_bench";
+    string baseline = "perf_baseline.json";
+    string dataDir = ".";
+    int runs = 5;
+    string minTime = "0.2";
+    double timeTolerance = 0.15;
+    double allocTolerance = 0.02;
+    double rssTolerance = 0.10;
+    bool update = false;
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// Json: just enough of a reader for the files tree_bench and this tool write.
+// ————————————————————————————————————————————————————————————————————————————————
+struct Json {
+    enum Kind { Null, Number, String, Array, Object } kind = Null;
+    double number = 0.0;
+    string text;
+    vector<Json> items;
+    vector<pair<string, Json>> fields;
+
+    const Json* get(const string &key) const {
+        for (auto const &f : fields) if (f.first == key) return &f.second;
+        return nullptr;
+    }
+    double num(const string &key) const {
+        const Json *v = get(key);
+        return v && v->kind == Number ? v->number : 0.0;
+    }
+    string str(const string &key) const {
+        const Json *v = get(key);
+        return v && v->kind == String ? v->text : string();
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(const string &input) : in(input) {}
+
+    bool parse(Json &out) {
+        bool ok = value(out);
+        skip();
+        return ok && pos == in.size();
+    }
+
+private:
+    const string &in;
+    size_t pos = 0;
+
+    void skip() { while (pos < in.size() && isspace(static_cast<unsigned char>(in[pos]))) ++pos; }
+
+    bool literal(const char *word) {
+        size_t n = char_traits<char>::length(word);
+        if (in.compare(pos, n, word) != 0) return false;
+        pos += n;
+        return true;
+    }
+
+    bool stringValue(string &out) {
+        if (in[pos] != '"') return false;
+        for (++pos; pos < in.size() && in[pos] != '"'; ++pos) {
+            if (in[pos] == '\\' && pos + 1 < in.size()) ++pos;
+            out += in[pos];
+        }
+        if (pos >= in.size()) return false;
+        ++pos;
+        return true;
+    }
+
+    bool value(Json &out) {
+        skip();
+        if (pos >= in.size()) return false;
+        char c = in[pos];
+        if (c == '{') {
+            out.kind = Json::Object;
+            ++pos;
+            skip();
+            if (pos < in.size() && in[pos] == '}') { ++pos; return true; }
+            while (true) {
+                skip();
+                string key;
+                if (pos >= in.size() || !stringValue(key)) return false;
+                skip();
+                if (pos >= in.size() || in[pos++] != ':') return false;
+                Json v;
+                if (!value(v)) return false;
+                out.fields.emplace_back(std::move(key), std::move(v));
+                skip();
+                if (pos < in.size() && in[pos] == ',') { ++pos; continue; }
+                if (pos < in.size() && in[pos] == '}') { ++pos; return true; }
+                return false;
+            }
+        }
+        if (c == '[') {
+            out.kind = Json::Array;
+            ++pos;
+            skip();
+            if (pos < in.size() && in[pos] == ']') { ++pos; return true; }
+            while (true) {
+                Json v;
+                if (!value(v)) return false;
+                out.items.push_back(std::move(v));
+                skip();
+                if (pos < in.size() && in[pos] == ',') { ++pos; continue; }
+                if (pos < in.size() && in[pos] == ']') { ++pos; return true; }
+                return false;
+            }
+        }
+        if (c == '"') {
+            out.kind = Json::String;
+            return stringValue(out.text);
+        }
+        if (literal("null")) return true;
+        if (literal("true") || literal("false")) return true;
+        char *end = nullptr;
+        out.kind = Json::Number;
+        out.number = strtod(in.c_str() + pos, &end);
+        if (end == in.c_str() + pos) return false;
+        pos = static_cast<size_t>(end - in.c_str());
+        return true;
+    }
+};
+
+static bool readJson(const string &path, Json &out) {
+    ifstream file(path);
+    if (!file.is_open()) return false;
+    stringstream text;
+    text << file.rdbuf();
+    string s = text.str();
+    return JsonReader(s).parse(out);
+}
+
+// Medians of one benchmark (or one dataset's RSS) across runs
+struct Metric {
+    string name, dataset;
+    vector<double> nsPerOp, bytesPerOp, allocsPerOp, peakRssKb;
+};
+
+static double median(vector<double> v) {
+    if (v.empty()) return 0.0;
+    sort(v.begin(), v.end());
+    size_t mid = v.size() / 2;
+    return v.size() % 2 ? v[mid] : (v[mid - 1] + v[mid]) / 2.0;
+}
+
+// Run the benchmark once with its default matrix; stdout is discarded
+static bool runBench(const GateOptions &opt, const string &jsonPath) {
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) dup2(devnull, STDOUT_FILENO);
+        execl(opt.bench.c_str(), opt.bench.c_str(), "--data", opt.dataDir.c_str(), "--min-time", opt.minTime.c_str(),
+              "--json", jsonPath.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void collect(const Json &run, map<string, Metric> &benchmarks, map<string, Metric> &datasets) {
+    if (const Json *list = run.get("benchmarks")) {
+        for (auto const &b : list->items) {
+            auto &m = benchmarks[b.str("name") + "/" + b.str("dataset")];
+            m.name = b.str("name");
+            m.dataset = b.str("dataset");
+            m.nsPerOp.push_back(b.num("ns_per_op"));
+            m.bytesPerOp.push_back(b.num("bytes_per_op"));
+            m.allocsPerOp.push_back(b.num("allocs_per_op"));
+        }
+    }
+    if (const Json *list = run.get("datasets")) {
+        for (auto const &d : list->items) datasets[d.str("dataset")].peakRssKb.push_back(d.num("peak_rss_kb"));
+    }
+}
+
+static bool writeBaseline(const string &path, int runs, const map<string, Metric> &benchmarks,
+                          const map<string, Metric> &datasets) {
+    ofstream out(path, ios::trunc);
+    if (!out.is_open()) return false;
+    char host[256] = {};
+    gethostname(host, sizeof host - 1);
+    out << "{\n  \"context\": {\"runs\": " << runs << ", \"host\": \"" << host << "\"},\n  \"benchmarks\": [\n"
+        << fixed << setprecision(3);
+    size_t i = 0;
+    for (auto const &[key, m] : benchmarks) {
+        out << "    {\"name\": \"" << m.name << "\", \"dataset\": \"" << m.dataset << "\""
+            << ", \"ns_per_op\": " << median(m.nsPerOp)
+            << ", \"bytes_per_op\": " << median(m.bytesPerOp)
+            << ", \"allocs_per_op\": " << median(m.allocsPerOp) << "}"
+            << (++i < benchmarks.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"datasets\": [\n" << setprecision(0);
+    i = 0;
+    for (auto const &[name, m] : datasets) {
+        out << "    {\"dataset\": \"" << name << "\", \"peak_rss_kb\": " << median(m.peakRssKb) << "}"
+            << (++i < datasets.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// ————————————————————————————————————————————————————————————————————————————————
+// Comparison: a metric regresses when it exceeds baseline * (1 + tolerance) + slack.
+// The slack keeps near-zero metrics (0.01 allocs/op, a few ns) from tripping the gate.
+// ————————————————————————————————————————————————————————————————————————————————
+class Verdict {
+public:
+    void check(const string &what, const string &key, double base, double now, double tolerance, double slack) {
+        bool worse = now > base * (1.0 + tolerance) + slack;
+        bool better = now < base * (1.0 - tolerance) - slack;
+        if (!worse && !better) return;
+        double change = base > 0 ? (now - base) / base * 100.0 : 100.0;
+        cout << (worse ? "REGRESSION " : "improved   ") << left << setw(52) << key << setw(10) << what << right
+             << fixed << setprecision(2) << setw(14) << base << " -> " << setw(14) << now
+             << "  (" << showpos << setprecision(1) << change << "%" << noshowpos << ")\n";
+        if (worse) ++regressions;
+        else ++improvements;
+    }
+
+    void missing(const string &key) {
+        cout << "MISSING    " << key << " (in baseline, not produced by this run)\n";
+        ++regressions;
+    }
+
+    int regressions = 0;
+    int improvements = 0;
+};
+
+int main(int argc, char *argv[]) {
+    GateOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--update") { opt.update = true; continue; }
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 2;
+        }
+        string value = argv[++i];
+        try {
+            if (flag == "--bench") opt.bench = value;
+            else if (flag == "--baseline") opt.baseline = value;
+            else if (flag == "--data") opt.dataDir = value;
+            else if (flag == "--runs") opt.runs = max(1, stoi(value));
+            else if (flag == "--min-time") opt.minTime = value;
+            else if (flag == "--time-tolerance") opt.timeTolerance = stod(value);
+            else if (flag == "--alloc-tolerance") opt.allocTolerance = stod(value);
+            else if (flag == "--rss-tolerance") opt.rssTolerance = stod(value);
+            else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 2;
+            }
+        } catch (const logic_error&) {
+            // invalid_argument and out_of_range from stoi/stod
+            cerr << "Invalid value for " << flag << ": \"" << value << "\"\n";
+            return 2;
+        }
+    }
+
+    char tmpl[] = "/tmp/perf_gate_XXXXXX";
+    int fd = mkstemp(tmpl);
+    if (fd < 0) {
+        cerr << "Could not create a temporary file\n";
+        return 2;
+    }
+    close(fd);
+    string runPath = tmpl;
+
+    map<string, Metric> benchmarks, datasets;
+    for (int r = 0; r < opt.runs; ++r) {
+        cerr << "run " << (r + 1) << "/" << opt.runs << "\n";
+        Json run;
+        if (!runBench(opt, runPath) || !readJson(runPath, run)) {
+            cerr << "Benchmark run failed: " << opt.bench << "\n";
+            remove(runPath.c_str());
+            return 2;
+        }
+        collect(run, benchmarks, datasets);
+    }
+    remove(runPath.c_str());
+
+    if (opt.update) {
+        if (!writeBaseline(opt.baseline, opt.runs, benchmarks, datasets)) {
+            cerr << "Could not write " << opt.baseline << "\n";
+            return 2;
+        }
+        cout << "Baseline written to " << opt.baseline << " (" << benchmarks.size() << " benchmarks)\n";
+        return 0;
+    }
+
+    Json base;
+    if (!readJson(opt.baseline, base)) {
+        cerr << "Could not read baseline " << opt.baseline << " (create it with --update)\n";
+        return 2;
+    }
+
+    Verdict verdict;
+    size_t compared = 0;
+    if (const Json *list = base.get("benchmarks")) {
+        for (auto const &b : list->items) {
+            string key = b.str("name") + "/" + b.str("dataset");
+            auto it = benchmarks.find(key);
+            if (it == benchmarks.end()) {
+                verdict.missing(key);
+                continue;
+            }
+            ++compared;
+            auto const &m = it->second;
+            verdict.check("ns/op", key, b.num("ns_per_op"), median(m.nsPerOp), opt.timeTolerance, 2.0);
+            verdict.check("B/op", key, b.num("bytes_per_op"), median(m.bytesPerOp), opt.allocTolerance, 1.0);
+            verdict.check("allocs/op", key, b.num("allocs_per_op"), median(m.allocsPerOp), opt.allocTolerance, 0.05);
+        }
+    }
+    if (const Json *list = base.get("datasets")) {
+        for (auto const &d : list->items) {
+            string name = d.str("dataset");
+            auto it = datasets.find(name);
+            if (it == datasets.end()) {
+                verdict.missing("peak RSS/" + name);
+                continue;
+            }
+            verdict.check("peak KB", "peak RSS/" + name, d.num("peak_rss_kb"), median(it->second.peakRssKb),
+                          opt.rssTolerance, 256.0);
+        }
+    }
+
+    cout << compared << " benchmarks compared over " << opt.runs << " runs: "
+         << verdict.regressions << " regressions, " << verdict.improvements << " improvements\n";
+    if (verdict.improvements && !verdict.regressions)
+        cout << "Consider refreshing the baseline with --update\n";
+    return verdict.regressions ? 1 : 0;
+}
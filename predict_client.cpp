@@ -0,0 +1,252 @@
+// predict_client.cpp
+//
+// Load generator for the prediction server: replays the rows of a CSV file over several
+// connections with a fixed number of requests in flight and reports throughput and
+// latency percentiles.
+//
+//   predict_bench --csv data.csv [--socket PATH | --port N] [--connections N]
+//                 [--requests N] [--pipeline N]
+
+#include "predict_protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct ClientOptions {
+    string socketPath;
+    int port = 7878;
+    string csv;
+    int connections = 4;
+    long requests = 100000;
+    int pipeline = 8;
+};
+
+static int connectServer(const ClientOptions &opt) {
+    int fd;
+    if (!opt.socketPath.empty()) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, opt.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(opt.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+            close(fd);
+            return -1;
+        }
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Read into buf until it holds one complete frame; returns the body length or 0 on error
+static uint32_t readFrame(int fd, string &buf) {
+    while (true) {
+        uint32_t len = PredictProtocol::completeFrame(buf, 0);
+        if (len == UINT32_MAX) return 0;
+        if (len > 0) return len;
+        char chunk[16 * 1024];
+        ssize_t n = recv(fd, chunk, sizeof chunk, 0);
+        if (n <= 0) return 0;
+        buf.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+struct WorkerResult {
+    vector<double> latenciesUs;
+    long unknown = 0;
+    long errors = 0;
+};
+
+static void runConnection(const ClientOptions &opt, const vector<string> &frames, long count, WorkerResult &result) {
+    using clock = chrono::steady_clock;
+    int fd = connectServer(opt);
+    if (fd < 0) {
+        result.errors = count;
+        return;
+    }
+
+    unordered_map<uint32_t, clock::time_point> inFlight;
+    string buf;
+    long sent = 0, received = 0;
+    PredictProtocol::Frame frame;
+    result.latenciesUs.reserve(static_cast<size_t>(count));
+
+    while (received < count) {
+        // Top up the pipeline, stamping each pre-encoded frame with its request id
+        string out;
+        while (sent < count && static_cast<long>(inFlight.size()) < opt.pipeline) {
+            uint32_t id = static_cast<uint32_t>(sent);
+            size_t at = out.size() + PredictProtocol::LengthPrefix + 1;    // id follows the kind byte
+            out += frames[static_cast<size_t>(sent) % frames.size()];
+            for (int i = 0; i < 4; ++i) out[at + i] = static_cast<char>(id >> (8 * i));
+            inFlight.emplace(id, clock::now());
+            ++sent;
+        }
+        if (!out.empty() && !sendAll(fd, out)) break;
+
+        uint32_t len = readFrame(fd, buf);
+        if (len == 0) break;
+        auto now = clock::now();
+        if (PredictProtocol::parseFrame(buf.data() + PredictProtocol::LengthPrefix, len, frame)) {
+            auto it = inFlight.find(frame.id);
+            if (it != inFlight.end()) {
+                result.latenciesUs.push_back(chrono::duration<double, micro>(now - it->second).count());
+                inFlight.erase(it);
+            }
+            if (frame.kind == PredictProtocol::Unknown) ++result.unknown;
+            else if (frame.kind != PredictProtocol::Ok) ++result.errors;
+        }
+        buf.erase(0, PredictProtocol::LengthPrefix + len);
+        ++received;
+    }
+    result.errors += count - received;
+    close(fd);
+}
+
+static double percentile(const vector<double> &sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+
+int main(int argc, char *argv[]) {
+    ClientOptions opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--socket") opt.socketPath = argv[i + 1];
+        else if (flag == "--port") opt.port = stoi(argv[i + 1]);
+        else if (flag == "--csv") opt.csv = argv[i + 1];
+        else if (flag == "--connections") opt.connections = max(1, stoi(argv[i + 1]));
+        else if (flag == "--requests") opt.requests = max(1L, stol(argv[i + 1]));
+        else if (flag == "--pipeline") opt.pipeline = max(1, stoi(argv[i + 1]));
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+    if (opt.csv.empty()) {
+        cerr << "Usage: " << argv[0] << " --csv data.csv [--socket PATH | --port N] [--connections N]"
+             << " [--requests N] [--pipeline N]\n";
+        return 1;
+    }
+
+    ifstream file(opt.csv);
+    if (!file.is_open()) {
+        cerr << "Error opening file: " << opt.csv << "\n";
+        return 1;
+    }
+    vector<vector<string>> table;
+    string line;
+    while (getline(file, line)) {
+        vector<string> row;
+        string cell;
+        istringstream cells(line);
+        while (getline(cells, cell, ',')) row.push_back(cell);
+        table.push_back(row);
+    }
+    if (table.size() < 2) {
+        cerr << "No data rows in " << opt.csv << "\n";
+        return 1;
+    }
+
+    // Ask the server for its attribute order and map the CSV columns onto it
+    int fd = connectServer(opt);
+    if (fd < 0) {
+        cerr << "Could not connect to server\n";
+        return 1;
+    }
+    string schemaReq, buf;
+    PredictProtocol::appendFrame(schemaReq, PredictProtocol::OpSchema, 0, vector<string_view>{});
+    uint32_t len = sendAll(fd, schemaReq) ? readFrame(fd, buf) : 0;
+    PredictProtocol::Frame schema;
+    if (len == 0 || !PredictProtocol::parseFrame(buf.data() + PredictProtocol::LengthPrefix, len, schema)) {
+        cerr << "Schema request failed\n";
+        close(fd);
+        return 1;
+    }
+    vector<int> column;
+    for (auto name : schema.fields) {
+        auto it = find(table[0].begin(), table[0].end(), name);
+        if (it == table[0].end()) {
+            cerr << "CSV has no column for attribute " << name << "\n";
+            close(fd);
+            return 1;
+        }
+        column.push_back(static_cast<int>(it - table[0].begin()));
+    }
+    close(fd);
+
+    // Pre-encode one request per row; the id is patched per send
+    vector<string> frames;
+    for (size_t r = 1; r < table.size(); ++r) {
+        vector<string_view> fields;
+        for (int c : column) fields.push_back(static_cast<size_t>(c) < table[r].size() ? string_view(table[r][c]) : "");
+        string frame;
+        PredictProtocol::appendFrame(frame, PredictProtocol::OpPredict, 0, fields);
+        frames.push_back(std::move(frame));
+    }
+
+    vector<WorkerResult> results(static_cast<size_t>(opt.connections));
+    vector<thread> workers;
+    long perConnection = opt.requests / opt.connections;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < opt.connections; ++c) {
+        long count = perConnection + (c == 0 ? opt.requests % opt.connections : 0);
+        workers.emplace_back(runConnection, cref(opt), cref(frames), count, ref(results[static_cast<size_t>(c)]));
+    }
+    for (auto &w : workers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> latencies;
+    long unknown = 0, errors = 0;
+    for (auto &r : results) {
+        latencies.insert(latencies.end(), r.latenciesUs.begin(), r.latenciesUs.end());
+        unknown += r.unknown;
+        errors += r.errors;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    cout << fixed << setprecision(1)
+         << "requests: " << latencies.size() << "  unknown: " << unknown << "  errors: " << errors << "\n"
+         << "throughput: " << static_cast<double>(latencies.size()) / seconds << " req/s\n"
+         << "latency us: p50 " << percentile(latencies, 0.50)
+         << "  p99 " << percentile(latencies, 0.99)
+         << "  p999 " << percentile(latencies, 0.999)
+         << "  max " << (latencies.empty() ? 0.0 : latencies.back()) << "\n";
+    return errors == 0 ? 0 : 1;
+}
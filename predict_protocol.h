@@ -0,0 +1,92 @@
+// predict_protocol.h
+//
+// Wire format shared by the prediction server and its benchmark client. Every frame is
+// a u32 little-endian length followed by that many bytes:
+//
+//   u8 kind, u32 id, u16 fieldCount, then fieldCount x (u16 length, bytes)
+//
+// Requests use kind = Op. OpPredict carries the attribute values in the model's
+// attribute order; OpSchema carries nothing. Responses use kind = Status and echo the
+// request id: a prediction answers with the label, a schema request with the model's
+// attribute names. Responses on one connection may arrive out of request order.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PredictProtocol {
+    enum Op : uint8_t { OpPredict = 1, OpSchema = 2 };
+    enum Status : uint8_t { Ok = 0, Unknown = 1, BadRequest = 2 };
+
+    constexpr uint32_t MaxFrame = 1u << 20;
+    constexpr size_t LengthPrefix = 4;
+
+    inline uint16_t load16(const char *p) {
+        auto b = reinterpret_cast<const unsigned char*>(p);
+        return static_cast<uint16_t>(b[0] | b[1] << 8);
+    }
+    inline uint32_t load32(const char *p) {
+        auto b = reinterpret_cast<const unsigned char*>(p);
+        return uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+    }
+    inline void put16(std::string &out, uint16_t v) {
+        out.push_back(static_cast<char>(v & 0xFF));
+        out.push_back(static_cast<char>(v >> 8));
+    }
+    inline void put32(std::string &out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+
+    // Append one complete frame (length prefix included) to out
+    template <class Fields>
+    void appendFrame(std::string &out, uint8_t kind, uint32_t id, const Fields &fields) {
+        size_t start = out.size();
+        put32(out, 0);
+        out.push_back(static_cast<char>(kind));
+        put32(out, id);
+        put16(out, static_cast<uint16_t>(fields.size()));
+        for (std::string_view f : fields) {
+            put16(out, static_cast<uint16_t>(f.size()));
+            out.append(f.data(), f.size());
+        }
+        uint32_t len = static_cast<uint32_t>(out.size() - start - LengthPrefix);
+        for (int i = 0; i < 4; ++i) out[start + i] = static_cast<char>(len >> (8 * i));
+    }
+
+    struct Frame {
+        uint8_t kind = 0;
+        uint32_t id = 0;
+        std::vector<std::string_view> fields;   // views into the parsed body
+    };
+
+    // Parse a frame body (the bytes after the length prefix)
+    inline bool parseFrame(const char *body, size_t size, Frame &frame) {
+        if (size < 7) return false;
+        frame.kind = static_cast<uint8_t>(body[0]);
+        frame.id = load32(body + 1);
+        uint16_t count = load16(body + 5);
+        frame.fields.clear();
+        size_t pos = 7;
+        for (uint16_t i = 0; i < count; ++i) {
+            if (pos + 2 > size) return false;
+            uint16_t len = load16(body + pos);
+            pos += 2;
+            if (pos + len > size) return false;
+            frame.fields.emplace_back(body + pos, len);
+            pos += len;
+        }
+        return pos == size;
+    }
+
+    // Length of the first complete frame body in buf, or 0 if more bytes are needed.
+    // Returns UINT32_MAX for a length that cannot be a valid frame.
+    inline uint32_t completeFrame(const std::string &buf, size_t offset) {
+        if (buf.size() - offset < LengthPrefix) return 0;
+        uint32_t len = load32(buf.data() + offset);
+        if (len > MaxFrame || len < 7) return UINT32_MAX;
+        return buf.size() - offset - LengthPrefix >= len ? len : 0;
+    }
+}
@@ -0,0 +1,405 @@
+// prediction_server.h
+//
+// Local prediction daemon: serves a MappedModel over a Unix domain socket or a loopback
+// TCP port using the PredictProtocol wire format. The model can be replaced while serving.
+
+#pragma once
+
+#include "decision_tree.h"
+#include "predict_protocol.h"
+#include "model_slot.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+struct ServerOptions {
+    string modelPath;                       // reopened by reload()
+    string socketPath;                      // Unix domain socket; used when non-empty
+    int port = 0;                           // otherwise a TCP port bound to 127.0.0.1
+    size_t maxBatch = 64;                   // flush a micro-batch at this many requests
+    chrono::microseconds maxWait{200};      // ... or when its oldest request waited this long
+    string metricsPath;                     // Prometheus text dump, rewritten periodically
+    chrono::seconds metricsInterval{10};
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// PredictionServer: the I/O thread (the caller of run()) accepts connections, frames
+// requests and coalesces them into micro-batches; a predictor thread scores each batch
+// with MappedModel::predictBatch and hands the encoded responses back to the I/O thread.
+// Every batch pins the model it started on, so reload() never drops or stalls requests.
+// ————————————————————————————————————————————————————————————————————————————————
+class PredictionServer {
+public:
+    PredictionServer(ModelSlot<MappedModel> &models, ServerOptions options)
+        : models(models), options(std::move(options)) {}
+
+    PredictionServer(const PredictionServer&) = delete;
+    PredictionServer& operator=(const PredictionServer&) = delete;
+
+    ~PredictionServer() {
+        for (auto &kv : connections) ::close(kv.second.fd);
+        if (listenFd >= 0) ::close(listenFd);
+        if (wakeFds[0] >= 0) ::close(wakeFds[0]);
+        if (wakeFds[1] >= 0) ::close(wakeFds[1]);
+        if (!options.socketPath.empty() && listenFd >= 0) unlink(options.socketPath.c_str());
+    }
+
+    // Bind and listen; returns false (with a message on cerr) on failure
+    bool start() {
+        if (pipe(wakeFds) != 0) {
+            cerr << "Could not create wake pipe\n";
+            return false;
+        }
+        setNonBlocking(wakeFds[0]);
+        setNonBlocking(wakeFds[1]);
+
+        if (!options.socketPath.empty()) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (options.socketPath.size() >= sizeof(addr.sun_path)) {
+                cerr << "Socket path too long: " << options.socketPath << "\n";
+                return false;
+            }
+            memcpy(addr.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+            listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            unlink(options.socketPath.c_str());
+            if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+                cerr << "Could not bind Unix socket: " << options.socketPath << "\n";
+                return false;
+            }
+        } else {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(options.port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            listenFd = socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            if (listenFd >= 0) setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+            if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+                cerr << "Could not bind 127.0.0.1:" << options.port << "\n";
+                return false;
+            }
+        }
+        if (listen(listenFd, 128) != 0) {
+            cerr << "listen() failed\n";
+            return false;
+        }
+        setNonBlocking(listenFd);
+        return true;
+    }
+
+    // Serve until stop() is called
+    void run() {
+        thread predictor([this] { predictorLoop(); });
+        vector<pollfd> fds;
+        vector<uint64_t> fdConn;
+        auto lastDump = chrono::steady_clock::now();
+
+        while (!stopping.load()) {
+            fds.clear();
+            fdConn.clear();
+            fds.push_back({listenFd, POLLIN, 0});
+            fds.push_back({wakeFds[0], POLLIN, 0});
+            for (auto &kv : connections) {
+                short events = POLLIN;
+                if (kv.second.out.size() > kv.second.outSent) events |= POLLOUT;
+                fds.push_back({kv.second.fd, events, 0});
+                fdConn.push_back(kv.first);
+            }
+
+            // Sleep until the open batch is due, or indefinitely (in 100 ms slices) if none
+            auto wait = chrono::microseconds(100000);
+            if (!batch.empty()) {
+                auto due = batchStart + options.maxWait - chrono::steady_clock::now();
+                wait = max(chrono::microseconds(0), chrono::duration_cast<chrono::microseconds>(due));
+            }
+            timespec ts{static_cast<time_t>(wait.count() / 1000000), static_cast<long>(wait.count() % 1000000) * 1000};
+            int ready = ppoll(fds.data(), fds.size(), &ts, nullptr);
+            if (ready < 0 && errno != EINTR) break;
+
+            if (reloadRequested.exchange(false)) startReload();
+
+            if (ready > 0) {
+                if (fds[0].revents & POLLIN) acceptClients();
+                if (fds[1].revents & POLLIN) collectCompletions();
+                for (size_t i = 2; i < fds.size(); ++i) {
+                    auto it = connections.find(fdConn[i - 2]);
+                    if (it == connections.end() || fds[i].revents == 0) continue;
+                    bool alive = true;
+                    if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) alive = readClient(it->second);
+                    if (alive && (fds[i].revents & POLLOUT)) alive = writeClient(it->second);
+                    if (!alive) closeClient(it);
+                }
+            }
+
+            if (!batch.empty() && (batch.size() >= options.maxBatch ||
+                                   chrono::steady_clock::now() - batchStart >= options.maxWait)) {
+                flushBatch();
+            }
+
+            if (!options.metricsPath.empty() && chrono::steady_clock::now() - lastDump >= options.metricsInterval) {
+                Metrics::global().dumpPrometheus(options.metricsPath);
+                lastDump = chrono::steady_clock::now();
+            }
+        }
+
+        if (!options.metricsPath.empty()) Metrics::global().dumpPrometheus(options.metricsPath);
+        {
+            lock_guard<mutex> lock(queueMutex);
+            predictorDone = true;
+        }
+        queueReady.notify_one();
+        predictor.join();
+        if (reloader.joinable()) reloader.join();
+    }
+
+    // Reopen options.modelPath in the background and publish it; in-flight batches
+    // finish on the old model. Safe to call from a signal handler.
+    void reload() {
+        reloadRequested.store(true);
+        if (wakeFds[1] >= 0) {
+            char c = 0;
+            [[maybe_unused]] ssize_t n = write(wakeFds[1], &c, 1);
+        }
+    }
+
+    // Safe to call from a signal handler: only an atomic store and a write()
+    void stop() {
+        stopping.store(true);
+        if (wakeFds[1] >= 0) {
+            char c = 0;
+            [[maybe_unused]] ssize_t n = write(wakeFds[1], &c, 1);
+        }
+    }
+
+private:
+    struct Connection {
+        uint64_t id = 0;
+        int fd = -1;
+        string in;
+        string out;
+        size_t outSent = 0;
+    };
+
+    struct Pending {
+        uint64_t connection;
+        string body;                    // frame body, parsed again by the predictor
+    };
+
+    struct Completion {
+        uint64_t connection;
+        string frames;
+    };
+
+    ModelSlot<MappedModel> &models;
+    ServerOptions options;
+    int listenFd = -1;
+    int wakeFds[2] = {-1, -1};
+    atomic<bool> stopping{false};
+    atomic<bool> reloadRequested{false};
+    atomic<bool> reloading{false};
+    atomic<bool> retiredPending{false};
+    thread reloader;
+
+    unordered_map<uint64_t, Connection> connections;
+    uint64_t nextConnection = 1;
+    vector<Pending> batch;
+    chrono::steady_clock::time_point batchStart;
+
+    mutex queueMutex;
+    condition_variable queueReady;
+    vector<vector<Pending>> queued;     // guarded by queueMutex
+    vector<Completion> completions;     // guarded by queueMutex
+    bool predictorDone = false;         // guarded by queueMutex
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) return;
+            setNonBlocking(fd);
+            if (options.socketPath.empty()) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            }
+            Connection &conn = connections[nextConnection];
+            conn.id = nextConnection++;
+            conn.fd = fd;
+        }
+    }
+
+    bool readClient(Connection &conn) {
+        char buf[64 * 1024];
+        while (true) {
+            ssize_t n = recv(conn.fd, buf, sizeof buf, 0);
+            if (n > 0) {
+                conn.in.append(buf, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0) return false;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno != EINTR) return false;
+        }
+
+        size_t offset = 0;
+        while (true) {
+            uint32_t len = PredictProtocol::completeFrame(conn.in, offset);
+            if (len == UINT32_MAX) return false;
+            if (len == 0) break;
+            const char *body = conn.in.data() + offset + PredictProtocol::LengthPrefix;
+            if (static_cast<uint8_t>(body[0]) == PredictProtocol::OpPredict) {
+                if (batch.empty()) batchStart = chrono::steady_clock::now();
+                batch.push_back({conn.id, string(body, len)});
+                if (batch.size() >= options.maxBatch) flushBatch();
+            } else {
+                answerDirect(conn, body, len);
+            }
+            offset += PredictProtocol::LengthPrefix + len;
+        }
+        conn.in.erase(0, offset);
+        return writeClient(conn);
+    }
+
+    // Requests that do not go through the predictor (schema and malformed ones)
+    void answerDirect(Connection &conn, const char *body, uint32_t len) {
+        PredictProtocol::Frame frame;
+        if (!PredictProtocol::parseFrame(body, len, frame) || frame.kind != PredictProtocol::OpSchema) {
+            PredictProtocol::appendFrame(conn.out, PredictProtocol::BadRequest, frame.id, vector<string_view>{});
+            return;
+        }
+        auto model = models.read();
+        vector<string_view> names;
+        for (uint32_t a = 0; a < model->attributeCount(); ++a) names.push_back(model->attribute(a));
+        PredictProtocol::appendFrame(conn.out, PredictProtocol::Ok, frame.id, names);
+    }
+
+    bool writeClient(Connection &conn) {
+        while (conn.outSent < conn.out.size()) {
+            ssize_t n = send(conn.fd, conn.out.data() + conn.outSent, conn.out.size() - conn.outSent, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.outSent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        conn.out.clear();
+        conn.outSent = 0;
+        return true;
+    }
+
+    void closeClient(unordered_map<uint64_t, Connection>::iterator it) {
+        ::close(it->second.fd);
+        connections.erase(it);
+    }
+
+    void flushBatch() {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            queued.push_back(std::move(batch));
+        }
+        batch = {};
+        queueReady.notify_one();
+    }
+
+    void startReload() {
+        if (reloading.load() || options.modelPath.empty()) return;
+        if (reloader.joinable()) reloader.join();
+        reloading.store(true);
+        reloader = thread([this] {
+            auto next = make_unique<MappedModel>();
+            if (next->open(options.modelPath)) {
+                if (models.swap(std::move(next)) > 0) retiredPending.store(true);
+                cout << "Reloaded model " << options.modelPath << endl;
+            }
+            reloading.store(false);
+        });
+    }
+
+    void collectCompletions() {
+        char drain[256];
+        while (read(wakeFds[0], drain, sizeof drain) > 0) {}
+
+        // Batches release their model before completing, so old models may be free now
+        if (retiredPending.load() && models.reclaim() == 0) retiredPending.store(false);
+
+        vector<Completion> done;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            done.swap(completions);
+        }
+        for (auto &c : done) {
+            auto it = connections.find(c.connection);
+            if (it == connections.end()) continue;      // client went away
+            it->second.out += c.frames;
+            if (!writeClient(it->second)) closeClient(it);
+        }
+    }
+
+    void predictorLoop() {
+        vector<vector<Pending>> work;
+        vector<PredictProtocol::Frame> frames;
+        vector<vector<string_view>> rows;
+        vector<uint32_t> labels;
+        vector<char> valid;
+
+        while (true) {
+            {
+                unique_lock<mutex> lock(queueMutex);
+                queueReady.wait(lock, [this] { return predictorDone || !queued.empty(); });
+                if (queued.empty()) return;
+                work.swap(queued);
+            }
+
+            vector<Completion> results;
+            for (auto &requests : work) {
+                auto model = models.read();
+                frames.resize(requests.size());
+                rows.resize(requests.size());
+                valid.assign(requests.size(), 0);
+                for (size_t i = 0; i < requests.size(); ++i) {
+                    valid[i] = PredictProtocol::parseFrame(requests[i].body.data(), requests[i].body.size(), frames[i]) &&
+                               frames[i].fields.size() == model->attributeCount();
+                    rows[i] = valid[i] ? frames[i].fields : vector<string_view>{};
+                }
+                model->predictBatch(rows, labels);
+
+                // Group the encoded responses per connection, preserving request order
+                for (size_t i = 0; i < requests.size(); ++i) {
+                    if (results.empty() || results.back().connection != requests[i].connection)
+                        results.push_back({requests[i].connection, {}});
+                    string &out = results.back().frames;
+                    if (!valid[i]) {
+                        PredictProtocol::appendFrame(out, PredictProtocol::BadRequest, frames[i].id, vector<string_view>{});
+                    } else if (labels[i] == MappedModel::None) {
+                        PredictProtocol::appendFrame(out, PredictProtocol::Unknown, frames[i].id, vector<string_view>{});
+                    } else {
+                        string_view lab = model->label(labels[i]);
+                        PredictProtocol::appendFrame(out, PredictProtocol::Ok, frames[i].id, vector<string_view>{lab});
+                    }
+                }
+            }
+            work.clear();
+
+            {
+                lock_guard<mutex> lock(queueMutex);
+                for (auto &r : results) completions.push_back(std::move(r));
+            }
+            char c = 1;
+            [[maybe_unused]] ssize_t n = write(wakeFds[1], &c, 1);
+        }
+    }
+};
@@ -0,0 +1,170 @@
+// progress.h
+//
+// Live training progress: the tree builder bumps relaxed counters as it goes, and callers
+// either poll TrainingProgress::global().snapshot() or run a ProgressReporter thread
+// that prints a line every few seconds. Every data row ends in exactly one leaf, so the
+// share of rows resolved into leaves is the completion estimate the ETA is based on.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+class TrainingProgress {
+public:
+    struct Snapshot {
+        bool running = false;
+        uint64_t totalRows = 0;
+        uint64_t rowsResolved = 0;          // rows that reached a leaf
+        uint64_t nodesBuilt = 0;
+        uint64_t leaves = 0;
+        uint32_t depth = 0;                 // depth of the node being built most recently
+        uint32_t maxDepth = 0;
+        int64_t frontier = 0;               // subtrees created but not started yet
+        double elapsedSeconds = 0.0;
+        double etaSeconds = -1.0;           // negative until the first leaf is reached
+
+        double fraction() const {
+            return totalRows ? static_cast<double>(rowsResolved) / static_cast<double>(totalRows) : 0.0;
+        }
+    };
+
+    static TrainingProgress& global() {
+        static TrainingProgress instance;
+        return instance;
+    }
+
+    void begin(uint64_t rows) {
+        totalRows.store(rows, std::memory_order_relaxed);
+        rowsResolved.store(0, std::memory_order_relaxed);
+        nodesBuilt.store(0, std::memory_order_relaxed);
+        leaves.store(0, std::memory_order_relaxed);
+        depth.store(0, std::memory_order_relaxed);
+        maxDepth.store(0, std::memory_order_relaxed);
+        frontier.store(1, std::memory_order_relaxed);          // the root
+        startNs.store(nowNs(), std::memory_order_relaxed);
+        running.store(true, std::memory_order_relaxed);
+    }
+
+    void finish() {
+        endNs.store(nowNs(), std::memory_order_relaxed);
+        running.store(false, std::memory_order_relaxed);
+    }
+
+    // A subtree starts being built at the given depth
+    void enterNode(uint32_t d) {
+        frontier.fetch_sub(1, std::memory_order_relaxed);
+        depth.store(d, std::memory_order_relaxed);
+        uint32_t prev = maxDepth.load(std::memory_order_relaxed);
+        while (d > prev && !maxDepth.compare_exchange_weak(prev, d, std::memory_order_relaxed)) {}
+    }
+
+    void addSplit(uint64_t children) {
+        nodesBuilt.fetch_add(1, std::memory_order_relaxed);
+        frontier.fetch_add(static_cast<int64_t>(children), std::memory_order_relaxed);
+    }
+
+    void addLeaf(uint64_t rows) {
+        nodesBuilt.fetch_add(1, std::memory_order_relaxed);
+        leaves.fetch_add(1, std::memory_order_relaxed);
+        rowsResolved.fetch_add(rows, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.running = running.load(std::memory_order_relaxed);
+        s.totalRows = totalRows.load(std::memory_order_relaxed);
+        s.rowsResolved = rowsResolved.load(std::memory_order_relaxed);
+        s.nodesBuilt = nodesBuilt.load(std::memory_order_relaxed);
+        s.leaves = leaves.load(std::memory_order_relaxed);
+        s.depth = depth.load(std::memory_order_relaxed);
+        s.maxDepth = maxDepth.load(std::memory_order_relaxed);
+        s.frontier = frontier.load(std::memory_order_relaxed);
+        uint64_t start = startNs.load(std::memory_order_relaxed);
+        uint64_t end = s.running ? nowNs() : endNs.load(std::memory_order_relaxed);
+        s.elapsedSeconds = static_cast<double>(end - start) * 1e-9;
+        if (!s.running) s.etaSeconds = 0.0;
+        else if (s.rowsResolved > 0)
+            s.etaSeconds = s.elapsedSeconds * static_cast<double>(s.totalRows - s.rowsResolved) / static_cast<double>(s.rowsResolved);
+        return s;
+    }
+
+    static void print(std::ostream &out, const Snapshot &s) {
+        char line[256];
+        std::snprintf(line, sizeof line,
+                      "[train] %5.1f%% rows resolved (%llu/%llu), %llu nodes (%llu leaves), depth %u (max %u), "
+                      "frontier %lld, elapsed %.1fs",
+                      s.fraction() * 100.0, static_cast<unsigned long long>(s.rowsResolved),
+                      static_cast<unsigned long long>(s.totalRows), static_cast<unsigned long long>(s.nodesBuilt),
+                      static_cast<unsigned long long>(s.leaves), s.depth, s.maxDepth,
+                      static_cast<long long>(s.frontier), s.elapsedSeconds);
+        out << line;
+        if (s.etaSeconds >= 0.0) {
+            std::snprintf(line, sizeof line, ", ETA %.1fs", s.etaSeconds);
+            out << line;
+        }
+        out << "\n";
+    }
+
+private:
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> totalRows{0};
+    std::atomic<uint64_t> rowsResolved{0};
+    std::atomic<uint64_t> nodesBuilt{0};
+    std::atomic<uint64_t> leaves{0};
+    std::atomic<uint32_t> depth{0};
+    std::atomic<uint32_t> maxDepth{0};
+    std::atomic<int64_t> frontier{0};
+    std::atomic<uint64_t> startNs{0};
+    std::atomic<uint64_t> endNs{0};
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// ProgressReporter: background thread printing a progress line every interval while
+// training runs, and a final line when it is destroyed.
+// ————————————————————————————————————————————————————————————————————————————————
+class ProgressReporter {
+public:
+    ProgressReporter(std::ostream &out, std::chrono::milliseconds interval)
+        : out(out), interval(interval), worker([this] { run(); }) {}
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    ~ProgressReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        TrainingProgress::print(out, TrainingProgress::global().snapshot());
+    }
+
+private:
+    std::ostream &out;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+            auto s = TrainingProgress::global().snapshot();
+            if (s.running) TrainingProgress::print(out, s);
+        }
+    }
+};
@@ -0,0 +1,81 @@
+// serve.cpp
+//
+// dtree_server: the prediction daemon on its own, without training or GUI code, for
+// scoring containers.
+
+#include "prediction_server.h"
+
+#include <csignal>
+
+static PredictionServer *activeServer = nullptr;
+
+static void stopServer(int) {
+    if (activeServer) activeServer->stop();
+}
+
+static void reloadServer(int) {
+    if (activeServer) activeServer->reload();
+}
+
+// dtree_server <model.bin> [--socket PATH | --port N] [--max-batch N] [--max-wait-us N]
+//                           [--metrics-file PATH] [--metrics-interval SECONDS]
+// Send SIGHUP after replacing model.bin (write a new file and rename it over) to hot-swap.
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <model.bin> [--socket PATH | --port N]"
+             << " [--max-batch N] [--max-wait-us N] [--metrics-file PATH] [--metrics-interval SECONDS]\n";
+        return 1;
+    }
+    ServerOptions options;
+    options.modelPath = argv[1];
+    options.port = 7878;
+    for (int i = 2; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << "\n";
+            return 1;
+        }
+        string value = argv[++i];
+        int number = 0;
+        uint16_t port = 0;
+        long micros = 0;
+        if (flag == "--socket") options.socketPath = value;
+        else if (flag == "--port") {
+            if (!parseNumber(flag, value, port)) return 1;
+            options.port = port;
+        }
+        else if (flag == "--max-batch") {
+            if (!parseNumber(flag, value, number)) return 1;
+            options.maxBatch = max(1, number);
+        }
+        else if (flag == "--max-wait-us") {
+            if (!parseNumber(flag, value, micros)) return 1;
+            options.maxWait = chrono::microseconds(max(0L, micros));
+        }
+        else if (flag == "--metrics-file") options.metricsPath = value;
+        else if (flag == "--metrics-interval") {
+            if (!parseNumber(flag, value, number)) return 1;
+            options.metricsInterval = chrono::seconds(max(1, number));
+        }
+        else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    auto model = make_unique<MappedModel>();
+    if (!model->open(argv[1])) return 1;
+    ModelSlot<MappedModel> models(std::move(model));
+    PredictionServer server(models, options);
+    if (!server.start()) return 1;
+
+    activeServer = &server;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    signal(SIGHUP, reloadServer);
+    cout << "Serving " << argv[1] << " on "
+         << (options.socketPath.empty() ? "127.0.0.1:" + to_string(options.port) : options.socketPath) << endl;
+    server.run();
+    activeServer = nullptr;
+    return 0;
+}
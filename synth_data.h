@@ -0,0 +1,165 @@
+// synth_data.h
+//
+// Seedable synthetic datasets with a known answer: rows are labelled by a randomly
+// planted decision tree, then a fraction of labels is flipped. Rows are generated one
+// at a time, so files of any length are written in constant memory.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct SynthSpec {
+    uint64_t rows = 1000;
+    size_t attributes = 6;
+    size_t defaultCardinality = 4;
+    std::vector<size_t> cardinality;    // per attribute; missing entries use defaultCardinality
+    size_t classes = 2;
+    double noise = 0.05;                // probability that a row's label is replaced
+    double skew = 0.0;                  // leaf classes drawn with weight 1 / (k + 1)^skew
+    size_t depth = 3;                   // depth of the planted tree
+    uint64_t seed = 42;
+
+    size_t cardinalityOf(size_t attr) const {
+        size_t c = attr < cardinality.size() ? cardinality[attr] : defaultCardinality;
+        return std::max<size_t>(c, 1);
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// SyntheticData: plants the tree in the constructor, then streams rows as CSV
+// (columns a0..aN-1 with values v0..vK-1, label column "class" with values c0..cC-1).
+// ————————————————————————————————————————————————————————————————————————————————
+class SyntheticData {
+public:
+    static constexpr size_t MaxPlantedLeaves = 1 << 20;
+
+    explicit SyntheticData(const SynthSpec &spec)
+        : spec(spec), rng(spec.seed)
+    {
+        this->spec.classes = std::max<size_t>(spec.classes, 1);
+        for (size_t a = 0; a < spec.attributes; ++a) {
+            std::vector<std::string> names;
+            for (size_t v = 0; v < spec.cardinalityOf(a); ++v) names.push_back("v" + std::to_string(v));
+            valueNames.push_back(std::move(names));
+        }
+        plant();
+    }
+
+    // Depth actually planted; smaller than requested when attributes or the leaf cap run out
+    size_t plantedDepth() const { return depthUsed; }
+
+    void writeCsv(std::ostream &out) {
+        std::string buf;
+        buf.reserve(BufferSize + 256);
+        for (size_t a = 0; a < spec.attributes; ++a) buf += "a" + std::to_string(a) + ",";
+        buf += "class\n";
+
+        std::vector<uint32_t> row(spec.attributes);
+        for (uint64_t r = 0; r < spec.rows; ++r) {
+            uint32_t lab = nextRow(row);
+            for (size_t a = 0; a < spec.attributes; ++a) {
+                buf += valueNames[a][row[a]];
+                buf += ',';
+            }
+            buf += 'c';
+            buf += std::to_string(lab);
+            buf += '\n';
+            if (buf.size() >= BufferSize) {
+                out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+                buf.clear();
+            }
+        }
+        out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    }
+
+    // Draw one row's attribute values and return its (possibly noisy) class
+    uint32_t nextRow(std::vector<uint32_t> &row) {
+        for (size_t a = 0; a < spec.attributes; ++a)
+            row[a] = static_cast<uint32_t>(std::uniform_int_distribution<size_t>(0, spec.cardinalityOf(a) - 1)(rng));
+        uint32_t lab = trueLabel(row);
+        if (spec.classes > 1 && std::bernoulli_distribution(spec.noise)(rng)) {
+            uint32_t other = static_cast<uint32_t>(std::uniform_int_distribution<size_t>(0, spec.classes - 2)(rng));
+            lab = other >= lab ? other + 1 : other;
+        }
+        return lab;
+    }
+
+    // Noise-free class of a row according to the planted tree
+    uint32_t trueLabel(const std::vector<uint32_t> &row) const {
+        const Planted *n = &planted[0];
+        while (n->attribute >= 0) n = &planted[n->firstChild + row[static_cast<size_t>(n->attribute)]];
+        return n->label;
+    }
+
+    // The planted tree, indented like DecisionTree::printTree
+    void printTree(std::ostream &out) const { printNode(out, 0, "", ""); }
+
+private:
+    static constexpr size_t BufferSize = 1 << 16;
+
+    struct Planted {
+        int attribute = -1;             // -1 for a leaf
+        uint32_t label = 0;
+        uint32_t firstChild = 0;        // children are contiguous, one per value
+    };
+
+    SynthSpec spec;
+    std::mt19937_64 rng;
+    std::vector<std::vector<std::string>> valueNames;
+    std::vector<Planted> planted;
+    size_t depthUsed = 0;
+
+    void plant() {
+        std::vector<double> weights;
+        for (size_t k = 0; k < spec.classes; ++k) weights.push_back(1.0 / std::pow(static_cast<double>(k + 1), spec.skew));
+        std::discrete_distribution<uint32_t> leafClass(weights.begin(), weights.end());
+
+        std::vector<size_t> order(spec.attributes);
+        for (size_t a = 0; a < order.size(); ++a) order[a] = a;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        // Level by level: every node at one level tests the same attribute, so the path
+        // never repeats a test and the tree is complete up to the planted depth. The leaf
+        // count is capped so the tree stays small next to the data it labels.
+        size_t leaves = 1;
+        planted.push_back({});
+        std::vector<uint32_t> level{0};
+        for (size_t d = 0; d < std::min(spec.depth, order.size()); ++d) {
+            size_t attr = order[d];
+            size_t card = spec.cardinalityOf(attr);
+            if (card < 2 || leaves * card > MaxPlantedLeaves) break;
+            leaves *= card;
+            std::vector<uint32_t> next;
+            for (uint32_t id : level) {
+                planted[id].attribute = static_cast<int>(attr);
+                planted[id].firstChild = static_cast<uint32_t>(planted.size());
+                for (size_t v = 0; v < card; ++v) {
+                    next.push_back(static_cast<uint32_t>(planted.size()));
+                    planted.push_back({});
+                }
+            }
+            level = std::move(next);
+            ++depthUsed;
+        }
+        for (uint32_t id : level) planted[id].label = leafClass(rng);
+    }
+
+    void printNode(std::ostream &out, uint32_t id, const std::string &indent, const std::string &edge) const {
+        const Planted &n = planted[id];
+        std::string prefix = edge.empty() ? indent : indent + "├── " + edge + ": ";
+        if (n.attribute < 0) {
+            out << prefix << "Leaf = c" << n.label << "\n";
+            return;
+        }
+        out << prefix << "Attribute = a" << n.attribute << "\n";
+        auto a = static_cast<size_t>(n.attribute);
+        for (size_t v = 0; v < spec.cardinalityOf(a); ++v)
+            printNode(out, n.firstChild + static_cast<uint32_t>(v), indent + "│   ", valueNames[a][v]);
+    }
+};
@@ -0,0 +1,145 @@
+// trace.h
+//
+// Optional span profiler writing Chrome Trace Event JSON (open it in Perfetto or
+// chrome://tracing). Spans cost one relaxed load while tracing is disabled.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ————————————————————————————————————————————————————————————————————————————————
+// TraceRecorder: collects complete ("X") events into per-thread buffers, so recording
+// never contends between builder threads, and writes them all out at the end.
+// ————————————————————————————————————————————————————————————————————————————————
+class TraceRecorder {
+public:
+    struct Event {
+        const char *name;
+        uint64_t startNs;
+        uint64_t durationNs;
+        std::string args;               // JSON object members, without braces
+    };
+
+    static TraceRecorder& global() {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    void enable() { enabled.store(true, std::memory_order_relaxed); }
+    void disable() { enabled.store(false, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    uint64_t now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    void record(Event &&event) {
+        threadBuffer().events.push_back(std::move(event));
+    }
+
+    bool write(const std::string &path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        char num[64];
+        for (auto const &buf : buffers) {
+            for (auto const &e : buf->events) {
+                if (!first) out << ",\n";
+                first = false;
+                out << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid;
+                std::snprintf(num, sizeof num, ",\"ts\":%.3f,\"dur\":%.3f", e.startNs / 1000.0, e.durationNs / 1000.0);
+                out << num << ",\"args\":{" << e.args << "}}";
+            }
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct ThreadBuffer {
+        uint32_t tid;
+        std::vector<Event> events;
+    };
+
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;     // guarded by buffersMutex
+
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer *mine = nullptr;
+        if (!mine) {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffers.back()->tid = static_cast<uint32_t>(buffers.size());
+            mine = buffers.back().get();
+        }
+        return *mine;
+    }
+};
+
+// ————————————————————————————————————————————————————————————————————————————————
+// TraceSpan: RAII span; args are attached as JSON and show up in the event details.
+// ————————————————————————————————————————————————————————————————————————————————
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name)
+        : active(TraceRecorder::global().isEnabled()) {
+        if (active) {
+            event.name = name;
+            event.startNs = TraceRecorder::global().now();
+        }
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    ~TraceSpan() {
+        if (!active) return;
+        event.durationNs = TraceRecorder::global().now() - event.startNs;
+        TraceRecorder::global().record(std::move(event));
+    }
+
+    TraceSpan& arg(const char *key, long long value) {
+        if (active) {
+            separator();
+            event.args += '"';
+            event.args += key;
+            event.args += "\":" + std::to_string(value);
+        }
+        return *this;
+    }
+
+    TraceSpan& arg(const char *key, std::string_view value) {
+        if (active) {
+            separator();
+            event.args += '"';
+            event.args += key;
+            event.args += "\":\"";
+            for (char c : value) {
+                if (c == '"' || c == '\\') event.args += '\\';
+                if (static_cast<unsigned char>(c) >= 0x20) event.args += c;
+            }
+            event.args += '"';
+        }
+        return *this;
+    }
+
+private:
+    bool active;
+    TraceRecorder::Event event{};
+
+    void separator() {
+        if (!event.args.empty()) event.args += ',';
+    }
+};
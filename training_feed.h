@@ -0,0 +1,89 @@
+// training_feed.h
+//
+// Append-only log of the nodes buildTree creates, for watching a training run live.
+// The builder thread appends, readers on other threads poll size() and read every event
+// below it. Events are written into fixed chunks that never move and each one is
+// published with a release store of the count, so neither side takes a lock.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+class TrainingFeed {
+public:
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    // Strings point into the training tree's arena and stay valid while the tree lives
+    struct Event {
+        uint32_t parent = NoNode;           // id (event index) of the parent, NoNode for the root
+        std::string_view edge;              // value on the edge from the parent
+        std::string_view attribute;         // split attribute; empty for a leaf
+        std::string_view label;             // leaf label (may itself be empty)
+        bool leaf = false;
+    };
+
+    static TrainingFeed& global() {
+        static TrainingFeed instance;
+        return instance;
+    }
+
+    TrainingFeed() = default;
+    TrainingFeed(const TrainingFeed&) = delete;
+    TrainingFeed& operator=(const TrainingFeed&) = delete;
+    ~TrainingFeed() {
+        if (!chunks) return;
+        for (size_t c = 0; c < MaxChunks; ++c) delete[] chunks[c].load(std::memory_order_relaxed);
+    }
+
+    // Start recording a new run; call before the builder starts and while nobody reads
+    void enable() {
+        if (!chunks) chunks = std::make_unique<std::atomic<Event*>[]>(MaxChunks);
+        count.store(0, std::memory_order_relaxed);
+        done.store(false, std::memory_order_relaxed);
+        enabled.store(true, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Builder side: append a node and return its id, or NoNode once the log is full
+    uint32_t publish(const Event &event) {
+        size_t n = count.load(std::memory_order_relaxed);
+        if (n >= MaxChunks * ChunkSize) return NoNode;
+        std::atomic<Event*> &chunk = chunks[n >> ChunkBits];
+        Event *slots = chunk.load(std::memory_order_relaxed);
+        if (!slots) {
+            slots = new Event[ChunkSize];
+            chunk.store(slots, std::memory_order_relaxed);     // published by the count below
+        }
+        slots[n & (ChunkSize - 1)] = event;
+        count.store(n + 1, std::memory_order_release);
+        return static_cast<uint32_t>(n);
+    }
+
+    // Builder side: no more events will follow
+    void finish() {
+        enabled.store(false, std::memory_order_relaxed);
+        done.store(true, std::memory_order_release);
+    }
+
+    // Reader side: check finished() before size() so a finished run's last events are seen
+    bool finished() const { return done.load(std::memory_order_acquire); }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    const Event& operator[](size_t i) const {
+        return chunks[i >> ChunkBits].load(std::memory_order_relaxed)[i & (ChunkSize - 1)];
+    }
+
+private:
+    static constexpr size_t ChunkBits = 12;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+    static constexpr size_t MaxChunks = size_t(1) << 16;           // 268M nodes
+
+    std::unique_ptr<std::atomic<Event*>[]> chunks;
+    std::atomic<size_t> count{0};
+    std::atomic<bool> enabled{false};
+    std::atomic<bool> done{false};
+};
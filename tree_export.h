@@ -0,0 +1,193 @@
+// tree_export.h
+//
+// Headless tree export for batch reports: SVG is streamed to the file one element at a
+// time, PNG is rendered offscreen through sf::RenderTexture with the viewer's TreeScene.
+// Neither opens a window or runs the interactive loop; only PNG needs the font file, and
+// PNG is only compiled into builds with SFML (DT_WITH_SFML).
+
+#pragma once
+
+#include "decision_tree.h"
+#include "tree_layout.h"
+#ifdef DT_WITH_SFML
+#include "tree_viewer.h"
+#endif
+
+#include <cstdio>
+
+struct ExportOptions {
+    string fontPath = "DejaVuSans.ttf";     // PNG labels
+    unsigned maxPixels = 4096;              // PNG: longest side; never drawn above 1:1
+};
+
+namespace TreeExport {
+    constexpr size_t BufferSize = 64 * 1024;
+
+    inline void appendNumber(string &buf, float v) {
+        char tmp[32];
+        int n = snprintf(tmp, sizeof tmp, "%.1f", v);
+        buf.append(tmp, static_cast<size_t>(n));
+    }
+
+    inline void appendEscaped(string &buf, string_view text) {
+        for (char c : text) {
+            switch (c) {
+            case '&': buf += "&amp;"; break;
+            case '<': buf += "&lt;"; break;
+            case '>': buf += "&gt;"; break;
+            case '"': buf += "&quot;"; break;
+            default: buf += c;
+            }
+        }
+    }
+
+    inline void flush(ostream &out, string &buf, bool force = false) {
+        if (!force && buf.size() < BufferSize) return;
+        out.write(buf.data(), static_cast<streamsize>(buf.size()));
+        buf.clear();
+    }
+
+    // Same picture as the viewer at full detail: edges, edge values, node discs, node
+    // labels, each in its own group so later groups paint over earlier ones
+    inline void writeSvg(const TreeLayout &layout, ostream &out) {
+        auto const &nodes = layout.nodes();
+        TreeLayout::Box b = layout.bounds();
+        string buf;
+        buf.reserve(BufferSize + 512);
+
+        buf += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"";
+        appendNumber(buf, b.width);
+        buf += "\" height=\"";
+        appendNumber(buf, b.height);
+        buf += "\" viewBox=\"";
+        appendNumber(buf, b.left); buf += ' ';
+        appendNumber(buf, b.top); buf += ' ';
+        appendNumber(buf, b.width); buf += ' ';
+        appendNumber(buf, b.height);
+        buf += "\" font-family=\"DejaVu Sans, sans-serif\" text-anchor=\"middle\" dominant-baseline=\"central\">\n"
+               "<rect x=\"";
+        appendNumber(buf, b.left);
+        buf += "\" y=\"";
+        appendNumber(buf, b.top);
+        buf += "\" width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+
+        buf += "<g stroke=\"black\">\n";
+        for (auto const &n : nodes) {
+            for (auto const &e : n.node->edges()) {
+                uint32_t c = e.child ? layout.indexOf(e.child) : TreeLayout::NoNode;
+                if (c == TreeLayout::NoNode) continue;
+                buf += "<line x1=\""; appendNumber(buf, n.position.x);
+                buf += "\" y1=\""; appendNumber(buf, n.position.y);
+                buf += "\" x2=\""; appendNumber(buf, nodes[c].position.x);
+                buf += "\" y2=\""; appendNumber(buf, nodes[c].position.y);
+                buf += "\"/>\n";
+            }
+            flush(out, buf);
+        }
+        buf += "</g>\n<g font-size=\"";
+        buf += to_string(TreeStyle::EdgeTextSize);
+        buf += "\" fill=\"blue\">\n";
+        for (auto const &n : nodes) {
+            for (auto const &e : n.node->edges()) {
+                uint32_t c = e.child ? layout.indexOf(e.child) : TreeLayout::NoNode;
+                if (c == TreeLayout::NoNode) continue;
+                buf += "<text x=\""; appendNumber(buf, (n.position.x + nodes[c].position.x) / 2.0f);
+                buf += "\" y=\""; appendNumber(buf, (n.position.y + nodes[c].position.y) / 2.0f);
+                buf += "\">"; appendEscaped(buf, e.value);
+                buf += "</text>\n";
+            }
+            flush(out, buf);
+        }
+        buf += "</g>\n<g stroke=\"black\" stroke-width=\"2\">\n";
+        for (auto const &n : nodes) {
+            buf += "<circle cx=\""; appendNumber(buf, n.position.x);
+            buf += "\" cy=\""; appendNumber(buf, n.position.y);
+            buf += "\" r=\""; appendNumber(buf, TreeStyle::NodeRadius);
+            buf += n.node->leaf ? "\" fill=\"#b4ffb4\"/>\n" : "\" fill=\"white\"/>\n";
+            flush(out, buf);
+        }
+        buf += "</g>\n<g font-size=\"";
+        buf += to_string(TreeStyle::NodeTextSize);
+        buf += "\">\n";
+        for (auto const &n : nodes) {
+            buf += "<text x=\""; appendNumber(buf, n.position.x);
+            buf += "\" y=\""; appendNumber(buf, n.position.y);
+            buf += "\">"; appendEscaped(buf, n.node->leaf ? n.node->label : n.node->attribute);
+            buf += "</text>\n";
+            flush(out, buf);
+        }
+        buf += "</g>\n</svg>\n";
+        flush(out, buf, true);
+    }
+
+    inline bool writeSvg(const TreeLayout &layout, const string &path) {
+        ofstream file(path, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error opening " << path << " for writing\n";
+            return false;
+        }
+        writeSvg(layout, file);
+        file.close();
+        if (!file) {
+            cerr << "Error writing " << path << "\n";
+            return false;
+        }
+        return true;
+    }
+
+#ifdef DT_WITH_SFML
+    // One offscreen frame of the viewer's scene fitted to the whole tree; zoomed out that
+    // far, TreeScene picks the level of detail that collapses unreadable subtrees
+    inline bool writePng(const TreeLayout &layout, const string &path, const ExportOptions &options) {
+        sf::Font font;
+        if (!font.loadFromFile(options.fontPath)) {
+            cerr << "ERROR: Could not load font \"" << options.fontPath << "\" for PNG export.\n";
+            return false;
+        }
+        TreeLayout::Box b = layout.bounds();
+        float longest = min<float>(static_cast<float>(options.maxPixels), static_cast<float>(sf::Texture::getMaximumSize()));
+        float scale = min(1.0f, longest / max(b.width, b.height));
+        auto width = max(1u, static_cast<unsigned>(ceil(b.width * scale)));
+        auto height = max(1u, static_cast<unsigned>(ceil(b.height * scale)));
+
+        sf::RenderTexture target;
+        if (!target.create(width, height)) {
+            cerr << "Could not create a " << width << "x" << height << " offscreen render target for " << path << "\n";
+            return false;
+        }
+        target.setView(sf::View(toRect(b)));
+        TreeScene scene(layout, font);
+        target.clear(sf::Color::White);
+        scene.draw(target);
+        target.display();
+        if (!target.getTexture().copyToImage().saveToFile(path)) {
+            cerr << "Error writing " << path << "\n";
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    // Lay the tree out and write it in the format named by the extension (.svg or .png)
+    inline bool write(const TreeNode *root, const string &path, const ExportOptions &options = {}) {
+        string ext = path.substr(min(path.size(), path.rfind('.')));
+        transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext != ".svg" && ext != ".png") {
+            cerr << "Unsupported export format for " << path << " (use .svg or .png)\n";
+            return false;
+        }
+        if (!root) {
+            cerr << "Nothing to export: the tree is empty\n";
+            return false;
+        }
+        TreeLayout layout(root);
+        if (ext == ".svg") return writeSvg(layout, path);
+#ifdef DT_WITH_SFML
+        return writePng(layout, path, options);
+#else
+        (void)options;
+        cerr << "PNG export needs a build with SFML (the CPLHW1 viewer); use .svg here\n";
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,213 @@
+// tree_layout.h
+//
+// Viewer-side positions for a tree: TreeNode carries no drawing state, so layouts live
+// in this side table indexed by node. Plain floats only, so the SVG exporter can use it
+// without SFML.
+
+#pragma once
+
+#include "decision_tree.h"
+
+// Sizes shared by every renderer (viewer, PNG and SVG), in layout units
+namespace TreeStyle {
+    constexpr float NodeRadius = 20.0f;
+    constexpr unsigned NodeTextSize = 14;
+    constexpr unsigned EdgeTextSize = 12;
+}
+
+// ————————————————————————————————————————————————————————————————————————————————
+// TreeLayout: tidy positions for the viewer in O(n), using Walker's algorithm with
+// Buchheim et al.'s linear-time apportioning. Nodes are numbered breadth-first, so
+// every node's children are contiguous and a reverse sweep reaches children before
+// parents; both walks are plain loops, so deep trees cannot overflow the stack. In a
+// DAG a shared node is laid out under the first parent that reaches it.
+// ————————————————————————————————————————————————————————————————————————————————
+class TreeLayout {
+public:
+    static constexpr float XSpacing = 100.0f;   // between neighbouring nodes on a level
+    static constexpr float YSpacing = 100.0f;   // between levels
+    static constexpr float Margin = 50.0f;      // around the outermost node centres
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    struct Point {
+        float x = 0.0f, y = 0.0f;
+    };
+    struct Box {
+        float left = 0.0f, top = 0.0f, width = 0.0f, height = 0.0f;
+    };
+
+    struct Node {
+        const TreeNode *node;
+        Point position;
+        uint32_t parent;            // NoNode for the root
+        uint32_t firstChild;        // layout children are [firstChild, firstChild + childCount)
+        uint32_t childCount;
+    };
+
+    explicit TreeLayout(const TreeNode *root) {
+        if (!root) return;
+        number(root);
+        place();
+    }
+
+    const vector<Node>& nodes() const { return laid; }
+    Box bounds() const { return area; }
+
+    // Breadth-first number of a node, NoNode if it is not reachable from the root
+    uint32_t indexOf(const TreeNode *node) const {
+        if (table.empty()) return NoNode;
+        size_t mask = table.size() - 1;
+        for (size_t s = slot(node, mask); table[s] != NoNode; s = (s + 1) & mask)
+            if (laid[table[s]].node == node) return table[s];
+        return NoNode;
+    }
+
+private:
+    // Per-node state of the first walk, dropped once positions are known
+    struct Walk {
+        double prelim = 0.0, mod = 0.0, change = 0.0, shift = 0.0;
+        double mid = 0.0;           // midpoint of the children, 0 for a leaf
+        uint32_t thread = NoNode;
+        uint32_t ancestor = 0;
+    };
+
+    vector<Node> laid;
+    vector<uint32_t> table;         // open addressing from node to index; NoNode marks empty
+    Box area;
+
+    static size_t slot(const TreeNode *node, size_t mask) {
+        uint64_t h = (reinterpret_cast<uintptr_t>(node) >> 4) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32)) & mask;
+    }
+
+    // Record a node unless already seen; grows by doubling, so there is no allocation per node
+    bool insert(const TreeNode *node, uint32_t id) {
+        if ((laid.size() + 1) * 2 > table.size()) {
+            table.assign(max<size_t>(64, table.size() * 2), NoNode);
+            size_t mask = table.size() - 1;
+            for (uint32_t i = 0; i < laid.size(); ++i) {
+                size_t s = slot(laid[i].node, mask);
+                while (table[s] != NoNode) s = (s + 1) & mask;
+                table[s] = i;
+            }
+        }
+        size_t mask = table.size() - 1;
+        size_t s = slot(node, mask);
+        for (; table[s] != NoNode; s = (s + 1) & mask)
+            if (laid[table[s]].node == node) return false;
+        table[s] = id;
+        return true;
+    }
+
+    void number(const TreeNode *root) {
+        insert(root, 0);
+        laid.push_back({root, {}, NoNode, 0, 0});
+        for (uint32_t i = 0; i < laid.size(); ++i) {
+            auto first = static_cast<uint32_t>(laid.size());
+            for (auto const &e : laid[i].node->edges()) {
+                auto id = static_cast<uint32_t>(laid.size());
+                if (e.child && insert(e.child, id)) laid.push_back({e.child, {}, i, 0, 0});
+            }
+            laid[i].firstChild = first;
+            laid[i].childCount = static_cast<uint32_t>(laid.size()) - first;
+        }
+    }
+
+    uint32_t nextLeft(const vector<Walk> &w, uint32_t v) const {
+        return laid[v].childCount ? laid[v].firstChild : w[v].thread;
+    }
+    uint32_t nextRight(const vector<Walk> &w, uint32_t v) const {
+        return laid[v].childCount ? laid[v].firstChild + laid[v].childCount - 1 : w[v].thread;
+    }
+
+    // Siblings are contiguous, so index differences count the subtrees between them
+    static void moveSubtree(vector<Walk> &w, uint32_t wm, uint32_t wp, double shift) {
+        double subtrees = static_cast<double>(wp - wm);
+        w[wp].change -= shift / subtrees;
+        w[wp].shift += shift;
+        w[wm].change += shift / subtrees;
+        w[wp].prelim += shift;
+        w[wp].mod += shift;
+    }
+
+    // Push v's subtree clear of its left siblings' subtrees, following the facing contours
+    void apportion(vector<Walk> &w, uint32_t v, uint32_t &defaultAncestor) const {
+        uint32_t vip = v, vop = v, vim = v - 1, vom = laid[laid[v].parent].firstChild;
+        double sip = w[vip].mod, sop = w[vop].mod, sim = w[vim].mod, som = w[vom].mod;
+        while (nextRight(w, vim) != NoNode && nextLeft(w, vip) != NoNode) {
+            vim = nextRight(w, vim);
+            vip = nextLeft(w, vip);
+            vom = nextLeft(w, vom);
+            vop = nextRight(w, vop);
+            w[vop].ancestor = v;
+            double shift = (w[vim].prelim + sim) - (w[vip].prelim + sip) + XSpacing;
+            if (shift > 0.0) {
+                uint32_t a = laid[w[vim].ancestor].parent == laid[v].parent ? w[vim].ancestor : defaultAncestor;
+                moveSubtree(w, a, v, shift);
+                sip += shift;
+                sop += shift;
+            }
+            sim += w[vim].mod;
+            sip += w[vip].mod;
+            som += w[vom].mod;
+            sop += w[vop].mod;
+        }
+        if (nextRight(w, vim) != NoNode && nextRight(w, vop) == NoNode) {
+            w[vop].thread = nextRight(w, vim);
+            w[vop].mod += sim - sop;
+        }
+        if (nextLeft(w, vip) != NoNode && nextLeft(w, vom) == NoNode) {
+            w[vom].thread = nextLeft(w, vip);
+            w[vom].mod += sip - som;
+            defaultAncestor = v;
+        }
+    }
+
+    void place() {
+        size_t n = laid.size();
+        vector<Walk> w(n);
+        for (uint32_t v = 0; v < n; ++v) w[v].ancestor = v;
+
+        // First walk, bottom-up: a node's children each get their preliminary x next to
+        // their left sibling and are apportioned, then the node records their midpoint
+        for (size_t v = n; v-- > 0; ) {
+            const Node &p = laid[v];
+            if (!p.childCount) continue;
+            uint32_t first = p.firstChild, last = first + p.childCount - 1;
+            uint32_t defaultAncestor = first;
+            w[first].prelim = w[first].mid;
+            for (uint32_t c = first + 1; c <= last; ++c) {
+                w[c].prelim = w[c - 1].prelim + XSpacing;
+                if (laid[c].childCount) w[c].mod = w[c].prelim - w[c].mid;
+                apportion(w, c, defaultAncestor);
+            }
+            double shift = 0.0, change = 0.0;
+            for (uint32_t c = last + 1; c-- > first; ) {
+                w[c].prelim += shift;
+                w[c].mod += shift;
+                change += w[c].change;
+                shift += w[c].shift + change;
+            }
+            w[v].mid = (w[first].prelim + w[last].prelim) / 2.0;
+        }
+        w[0].prelim = w[0].mid;
+
+        // Second walk, top-down: sum the ancestors' modifiers into final positions and
+        // bounds; `change` now carries that running sum
+        w[0].change = 0.0;
+        float minX = FLT_MAX, maxX = -FLT_MAX, maxY = Margin;
+        for (uint32_t v = 0; v < n; ++v) {
+            Node &node = laid[v];
+            float y = Margin;
+            if (node.parent != NoNode) {
+                w[v].change = w[node.parent].change + w[node.parent].mod;
+                y = laid[node.parent].position.y + YSpacing;
+            }
+            node.position = {static_cast<float>(w[v].prelim + w[v].change), y};
+            minX = min(minX, node.position.x);
+            maxX = max(maxX, node.position.x);
+            maxY = max(maxY, y);
+        }
+        area = {minX - Margin, 0.0f, (maxX - minX) + 2 * Margin, maxY + Margin};
+    }
+};
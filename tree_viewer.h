@@ -0,0 +1,646 @@
+// tree_viewer.h
+//
+// The SFML viewer: TreeScene turns a TreeLayout into batched, culled geometry,
+// visualizeTree runs the interactive window and visualizeTraining watches a build grow.
+// Only the CPLHW1 viewer target includes this; the core, CLI and server builds do not
+// link SFML.
+
+#pragma once
+
+#include "decision_tree.h"
+#include "tree_layout.h"
+
+#include <chrono>
+#include <thread>
+
+#include <SFML/Graphics.hpp>   // link with -lsfml-graphics -lsfml-window -lsfml-system
+
+inline sf::FloatRect toRect(const TreeLayout::Box &b) {
+    return sf::FloatRect(b.left, b.top, b.width, b.height);
+}
+
+// ————————————————————————————————————————————————————————————————————————————————
+// TreeScene: the viewer's geometry behind a uniform grid per level of detail, so a
+// frame only touches the cells the view overlaps. Level 0 has every node, edge and
+// label; each coarser level serves twice the zoom-out of the one before, drops labels,
+// and draws any subtree narrower than a few pixels as a single triangle glyph. A cell's
+// vertices are built the first time it is seen and cached under a vertex budget.
+// ————————————————————————————————————————————————————————————————————————————————
+class TreeScene {
+public:
+    static constexpr float NodeRadius = TreeStyle::NodeRadius;
+    static constexpr unsigned NodeTextSize = TreeStyle::NodeTextSize;
+    static constexpr unsigned EdgeTextSize = TreeStyle::EdgeTextSize;
+
+    static constexpr float LabelMaxUnitsPerPixel = 2.5f;   // further out, labels are unreadable
+    static constexpr float CollapsePixels = 8.0f;          // narrower subtrees become one glyph
+    static constexpr float CellPixels = 512.0f;            // cell size on screen at a level's widest zoom
+    static constexpr size_t CacheVertexBudget = size_t(4) << 20;
+
+    TreeScene(const TreeLayout &layout, const sf::Font &font)
+        : font(font)
+    {
+        indexNodes(layout);
+        makeDiscTexture();
+        if (nodes.empty()) return;
+        float maxUnitsPerPixel = LabelMaxUnitsPerPixel;
+        do {
+            levels.push_back(buildLevel(maxUnitsPerPixel, levels.empty()));
+            maxUnitsPerPixel *= 2.0f;
+        } while (!levels.back().rootCollapsed && levels.size() < MaxLevels);
+    }
+
+    void draw(sf::RenderTarget &target) {
+        if (levels.empty()) return;
+        const sf::View &view = target.getView();
+        float unitsPerPixel = view.getSize().x / static_cast<float>(max(1u, target.getSize().x));
+        size_t l = 0;
+        while (l + 1 < levels.size() && unitsPerPixel > levels[l].maxUnitsPerPixel) ++l;
+        const Level &level = levels[l];
+
+        // Cells whose items can reach into the view: its rect grown by the level's margin
+        sf::Vector2f center = view.getCenter(), half = view.getSize() / 2.0f;
+        int c0 = column(level, center.x - half.x - level.margin.x), c1 = column(level, center.x + half.x + level.margin.x);
+        int r0 = row(level, center.y - half.y - level.margin.y), r1 = row(level, center.y + half.y + level.margin.y);
+        visible.clear();
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c)
+                visible.push_back(&cellGeometry(l, static_cast<size_t>(r) * level.cols + c));
+
+        sf::RenderStates edgeFont(&font.getTexture(EdgeTextSize));
+        sf::RenderStates nodeFont(&font.getTexture(NodeTextSize));
+        for (auto *g : visible) target.draw(g->lines);
+        for (auto *g : visible) target.draw(g->glyphs);
+        for (auto *g : visible) target.draw(g->edgeText, edgeFont);
+        for (auto *g : visible) target.draw(g->discs, sf::RenderStates(&discTexture));
+        for (auto *g : visible) target.draw(g->nodeText, nodeFont);
+
+        evict();
+        ++frame;
+    }
+
+private:
+    static constexpr float OutlineThickness = 2.0f;
+    static constexpr unsigned DiscTextureSize = 128;
+    static constexpr size_t MaxLevels = 32;
+    static constexpr uint32_t KindShift = 30;
+    enum ItemKind : uint32_t { NodeItem, GlyphItem, EdgeLabelItem };
+
+    struct SceneNode {
+        const TreeNode *node;
+        sf::Vector2f position;
+        float minX, maxX, maxY;     // extent of the layout subtree's node centres
+        uint32_t firstChild, childCount;    // layout children
+        uint32_t firstEdge, edgeCount;      // every edge, including those to shared nodes
+    };
+    struct SceneEdge {
+        uint32_t parent, child;
+        string_view value;
+    };
+    struct Level {
+        float maxUnitsPerPixel;
+        float collapseWidth;        // internal nodes narrower than this are glyphs; 0 on level 0
+        bool labels;
+        bool rootCollapsed = false;
+        float cellSize;
+        int cols = 1, rows = 1;
+        sf::Vector2f margin;        // furthest an item's geometry reaches from its anchor
+        vector<uint32_t> itemStart, items;      // per cell: anchored items, kind in the top bits
+        vector<uint32_t> edgeStart, edgeItems;  // per cell: edges crossing it
+    };
+    struct CellGeometry {
+        sf::VertexArray lines{sf::Lines};
+        sf::VertexArray glyphs{sf::Triangles};
+        sf::VertexArray edgeText{sf::Quads};
+        sf::VertexArray discs{sf::Quads};
+        sf::VertexArray nodeText{sf::Quads};
+        uint64_t lastFrame = 0;
+
+        size_t vertexCount() const {
+            return lines.getVertexCount() + glyphs.getVertexCount() + edgeText.getVertexCount()
+                 + discs.getVertexCount() + nodeText.getVertexCount();
+        }
+    };
+
+    const sf::Font &font;
+    sf::Texture discTexture;            // white fill, black outline; vertex colour tints the fill
+    vector<SceneNode> nodes;            // in layout order: breadth-first, root first
+    vector<SceneEdge> edges;
+    sf::Vector2f origin, extent;        // bounds of all node centres
+    vector<Level> levels;
+    unordered_map<uint64_t, CellGeometry> cache;
+    size_t cachedVertices = 0;
+    uint64_t frame = 1;
+    vector<CellGeometry*> visible;
+
+    // Take the layout's nodes and edges, and each node's subtree extent bottom-up
+    void indexNodes(const TreeLayout &layout) {
+        auto const &laid = layout.nodes();
+        if (laid.empty()) return;
+        nodes.reserve(laid.size());
+        for (auto const &l : laid) {
+            auto id = static_cast<uint32_t>(nodes.size());
+            nodes.push_back({l.node, sf::Vector2f(l.position.x, l.position.y), l.position.x, l.position.x, l.position.y,
+                             l.firstChild, l.childCount, static_cast<uint32_t>(edges.size()), 0});
+            for (auto const &e : l.node->edges()) {
+                if (!e.child) continue;
+                edges.push_back({id, layout.indexOf(e.child), e.value});
+                ++nodes.back().edgeCount;
+            }
+        }
+        for (size_t v = nodes.size(); v-- > 0; ) {
+            SceneNode &s = nodes[v];
+            for (uint32_t c = s.firstChild; c < s.firstChild + s.childCount; ++c) {
+                s.minX = min(s.minX, nodes[c].minX);
+                s.maxX = max(s.maxX, nodes[c].maxX);
+                s.maxY = max(s.maxY, nodes[c].maxY);
+            }
+        }
+        origin = sf::Vector2f(nodes[0].minX, nodes[0].position.y);
+        extent = sf::Vector2f(nodes[0].maxX - nodes[0].minX, nodes[0].maxY - nodes[0].position.y);
+    }
+
+    void makeDiscTexture() {
+        sf::Image image;
+        image.create(DiscTextureSize, DiscTextureSize, sf::Color::Transparent);
+        float outer = DiscTextureSize / 2.0f;
+        float inner = outer * NodeRadius / (NodeRadius + OutlineThickness);
+        for (unsigned y = 0; y < DiscTextureSize; ++y) {
+            for (unsigned x = 0; x < DiscTextureSize; ++x) {
+                float d = hypot(x + 0.5f - outer, y + 0.5f - outer);
+                float coverage = clamp(outer - d + 0.5f, 0.0f, 1.0f);
+                float fill = clamp(inner - d + 0.5f, 0.0f, 1.0f);
+                auto shade = static_cast<uint8_t>(255.0f * fill);
+                image.setPixel(x, y, sf::Color(shade, shade, shade, static_cast<uint8_t>(255.0f * coverage)));
+            }
+        }
+        discTexture.loadFromImage(image);
+        discTexture.setSmooth(true);
+        discTexture.generateMipmap();
+    }
+
+    int column(const Level &level, float x) const {
+        return clamp(static_cast<int>(floor((x - origin.x) / level.cellSize)), 0, level.cols - 1);
+    }
+    int row(const Level &level, float y) const {
+        return clamp(static_cast<int>(floor((y - origin.y) / level.cellSize)), 0, level.rows - 1);
+    }
+    uint32_t cellOf(const Level &level, sf::Vector2f p) const {
+        return static_cast<uint32_t>(row(level, p.y) * level.cols + column(level, p.x));
+    }
+    sf::FloatRect cellRect(const Level &level, size_t cell) const {
+        float s = level.cellSize;
+        return sf::FloatRect(origin.x + (cell % level.cols) * s, origin.y + (cell / level.cols) * s, s, s);
+    }
+
+    // Triangle from a collapsed subtree's root down over the width of its leaves
+    void glyphCorners(const SceneNode &s, sf::Vector2f &left, sf::Vector2f &right) const {
+        float bottom = s.maxY + NodeRadius;
+        left = sf::Vector2f(min(s.minX, s.position.x - NodeRadius), bottom);
+        right = sf::Vector2f(max(s.maxX, s.position.x + NodeRadius), bottom);
+    }
+
+    static void bucket(vector<pair<uint32_t, uint32_t>> &pairs, size_t cells,
+                       vector<uint32_t> &start, vector<uint32_t> &items) {
+        start.assign(cells + 1, 0);
+        for (auto const &p : pairs) ++start[p.first + 1];
+        for (size_t c = 0; c < cells; ++c) start[c + 1] += start[c];
+        items.resize(pairs.size());
+        vector<uint32_t> fill(start.begin(), start.end() - 1);
+        for (auto const &p : pairs) items[fill[p.first]++] = p.second;
+        pairs.clear();
+        pairs.shrink_to_fit();
+    }
+
+    // Walk the layout tree from the root, stopping at subtrees narrower than the level's
+    // collapse width, and file every node, glyph, edge and edge label by grid cell
+    Level buildLevel(float maxUnitsPerPixel, bool full) {
+        Level level;
+        level.maxUnitsPerPixel = maxUnitsPerPixel;
+        level.collapseWidth = full ? 0.0f : CollapsePixels * maxUnitsPerPixel;
+        level.labels = full;
+        level.cellSize = CellPixels * maxUnitsPerPixel;
+        level.cols = static_cast<int>(extent.x / level.cellSize) + 1;
+        level.rows = static_cast<int>(extent.y / level.cellSize) + 1;
+        level.margin = sf::Vector2f(NodeRadius + OutlineThickness, NodeRadius + OutlineThickness);
+
+        vector<pair<uint32_t, uint32_t>> anchored, crossing;
+        vector<uint32_t> stack{0};
+        while (!stack.empty()) {
+            uint32_t id = stack.back();
+            stack.pop_back();
+            const SceneNode &s = nodes[id];
+
+            if (s.childCount && s.maxX - s.minX < level.collapseWidth) {
+                sf::Vector2f left, right;
+                glyphCorners(s, left, right);
+                level.margin.x = max(level.margin.x, max(s.position.x - left.x, right.x - s.position.x));
+                level.margin.y = max(level.margin.y, left.y - s.position.y);
+                anchored.push_back({cellOf(level, s.position), id | (GlyphItem << KindShift)});
+                if (id == 0) level.rootCollapsed = true;
+                continue;
+            }
+
+            anchored.push_back({cellOf(level, s.position), id | (NodeItem << KindShift)});
+            if (level.labels) {
+                string_view text = s.node->leaf ? s.node->label : s.node->attribute;
+                level.margin.x = max(level.margin.x, text.size() * NodeTextSize / 2.0f);
+            }
+            for (uint32_t e = s.firstEdge; e < s.firstEdge + s.edgeCount; ++e) {
+                const SceneEdge &edge = edges[e];
+                sf::Vector2f a = s.position, b = nodes[edge.child].position;
+                fileEdge(level, a, b, e, crossing);
+                if (level.labels) {
+                    level.margin.x = max(level.margin.x, edge.value.size() * EdgeTextSize / 2.0f);
+                    anchored.push_back({cellOf(level, (a + b) / 2.0f), e | (EdgeLabelItem << KindShift)});
+                }
+            }
+            for (uint32_t c = s.firstChild; c < s.firstChild + s.childCount; ++c) stack.push_back(c);
+        }
+
+        size_t cells = static_cast<size_t>(level.cols) * level.rows;
+        bucket(anchored, cells, level.itemStart, level.items);
+        bucket(crossing, cells, level.edgeStart, level.edgeItems);
+        return level;
+    }
+
+    // File an edge under every cell its segment passes through
+    void fileEdge(const Level &level, sf::Vector2f a, sf::Vector2f b, uint32_t e,
+                  vector<pair<uint32_t, uint32_t>> &crossing) const {
+        if (a.x > b.x) swap(a, b);
+        int c0 = column(level, a.x), c1 = column(level, b.x);
+        for (int c = c0; c <= c1; ++c) {
+            float y0 = a.y, y1 = b.y;
+            if (c0 != c1) {
+                float x0 = max(a.x, origin.x + c * level.cellSize);
+                float x1 = min(b.x, origin.x + (c + 1) * level.cellSize);
+                float slope = (b.y - a.y) / (b.x - a.x);
+                y0 = a.y + (x0 - a.x) * slope;
+                y1 = a.y + (x1 - a.x) * slope;
+            }
+            int r0 = row(level, min(y0, y1)), r1 = row(level, max(y0, y1));
+            for (int r = r0; r <= r1; ++r)
+                crossing.push_back({static_cast<uint32_t>(r * level.cols + c), e});
+        }
+    }
+
+    // Liang–Barsky: clip segment a-b to the rect, false if nothing is left
+    static bool clip(sf::Vector2f &a, sf::Vector2f &b, const sf::FloatRect &r) {
+        float t0 = 0.0f, t1 = 1.0f;
+        float dx = b.x - a.x, dy = b.y - a.y;
+        const float p[4] = {-dx, dx, -dy, dy};
+        const float q[4] = {a.x - r.left, r.left + r.width - a.x, a.y - r.top, r.top + r.height - a.y};
+        for (int i = 0; i < 4; ++i) {
+            if (p[i] == 0.0f) {
+                if (q[i] < 0.0f) return false;
+                continue;
+            }
+            float t = q[i] / p[i];
+            if (p[i] < 0.0f) t0 = max(t0, t);
+            else t1 = min(t1, t);
+            if (t0 > t1) return false;
+        }
+        sf::Vector2f start = a;
+        a = sf::Vector2f(start.x + t0 * dx, start.y + t0 * dy);
+        b = sf::Vector2f(start.x + t1 * dx, start.y + t1 * dy);
+        return true;
+    }
+
+    CellGeometry& cellGeometry(size_t l, size_t cell) {
+        auto [it, inserted] = cache.try_emplace((static_cast<uint64_t>(l) << 48) | cell);
+        CellGeometry &g = it->second;
+        g.lastFrame = frame;
+        if (!inserted) return g;
+
+        const Level &level = levels[l];
+        sf::FloatRect rect = cellRect(level, cell);
+        for (uint32_t i = level.edgeStart[cell]; i < level.edgeStart[cell + 1]; ++i) {
+            const SceneEdge &edge = edges[level.edgeItems[i]];
+            sf::Vector2f a = nodes[edge.parent].position, b = nodes[edge.child].position;
+            if (!clip(a, b, rect)) continue;
+            g.lines.append(sf::Vertex(a, sf::Color::Black));
+            g.lines.append(sf::Vertex(b, sf::Color::Black));
+        }
+        for (uint32_t i = level.itemStart[cell]; i < level.itemStart[cell + 1]; ++i) {
+            uint32_t item = level.items[i], id = item & ((1u << KindShift) - 1);
+            switch (item >> KindShift) {
+            case NodeItem: {
+                const SceneNode &s = nodes[id];
+                bool leaf = s.node->leaf;
+                appendDisc(g.discs, s.position, leaf ? sf::Color(180,255,180) : sf::Color::White);
+                if (level.labels)
+                    appendLabel(g.nodeText, leaf ? s.node->label : s.node->attribute,
+                                NodeTextSize, s.position, -5.0f, sf::Color::Black);
+                break;
+            }
+            case GlyphItem: {
+                sf::Vector2f left, right;
+                glyphCorners(nodes[id], left, right);
+                g.glyphs.append(sf::Vertex(nodes[id].position, sf::Color(150,150,150)));
+                g.glyphs.append(sf::Vertex(left, sf::Color(150,150,150)));
+                g.glyphs.append(sf::Vertex(right, sf::Color(150,150,150)));
+                break;
+            }
+            case EdgeLabelItem: {
+                const SceneEdge &edge = edges[id];
+                sf::Vector2f mid = (nodes[edge.parent].position + nodes[edge.child].position) / 2.0f;
+                appendLabel(g.edgeText, edge.value, EdgeTextSize, mid, 0.0f, sf::Color::Blue);
+                break;
+            }
+            }
+        }
+        cachedVertices += g.vertexCount();
+        return g;
+    }
+
+    // Over budget: drop the cells that have gone longest without being drawn
+    void evict() {
+        if (cachedVertices <= CacheVertexBudget) return;
+        vector<pair<uint64_t, uint64_t>> stale;      // last frame drawn, key
+        for (auto const &[key, g] : cache)
+            if (g.lastFrame != frame) stale.push_back({g.lastFrame, key});
+        sort(stale.begin(), stale.end());
+        for (auto const &[lastFrame, key] : stale) {
+            if (cachedVertices <= CacheVertexBudget / 2) break;
+            auto it = cache.find(key);
+            cachedVertices -= it->second.vertexCount();
+            cache.erase(it);
+        }
+    }
+
+    void appendDisc(sf::VertexArray &out, sf::Vector2f center, sf::Color fill) const {
+        float r = NodeRadius + OutlineThickness, t = static_cast<float>(DiscTextureSize);
+        out.append(sf::Vertex(center + sf::Vector2f(-r, -r), fill, sf::Vector2f(0, 0)));
+        out.append(sf::Vertex(center + sf::Vector2f(r, -r), fill, sf::Vector2f(t, 0)));
+        out.append(sf::Vertex(center + sf::Vector2f(r, r), fill, sf::Vector2f(t, t)));
+        out.append(sf::Vertex(center + sf::Vector2f(-r, r), fill, sf::Vector2f(0, t)));
+    }
+
+    // Decode one UTF-8 code point, advancing i; malformed bytes map to '?'
+    static uint32_t nextCodePoint(string_view s, size_t &i) {
+        unsigned char c = static_cast<unsigned char>(s[i++]);
+        int extra = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+        if (extra < 0) return '?';
+        uint32_t cp = extra == 0 ? c : c & (0x3F >> extra);
+        for (int k = 0; k < extra; ++k) {
+            if (i >= s.size() || (static_cast<unsigned char>(s[i]) & 0xC0) != 0x80) return '?';
+            cp = (cp << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+        }
+        return cp;
+    }
+
+    // Lay a label out the way sf::Text does, then centre its bounds on `center`
+    void appendLabel(sf::VertexArray &out, string_view text, unsigned size, sf::Vector2f center,
+                     float yOffset, sf::Color color) {
+        size_t first = out.getVertexCount();
+        float x = 0.0f;
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        uint32_t prev = 0;
+        for (size_t i = 0; i < text.size(); ) {
+            uint32_t cp = nextCodePoint(text, i);
+            x += font.getKerning(prev, cp, size);
+            prev = cp;
+            const sf::Glyph &g = font.getGlyph(cp, size, false);
+            float left = x + g.bounds.left, top = static_cast<float>(size) + g.bounds.top;
+            float right = left + g.bounds.width, bottom = top + g.bounds.height;
+            float u0 = static_cast<float>(g.textureRect.left), v0 = static_cast<float>(g.textureRect.top);
+            float u1 = u0 + static_cast<float>(g.textureRect.width), v1 = v0 + static_cast<float>(g.textureRect.height);
+            out.append(sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u0, v0)));
+            out.append(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u1, v0)));
+            out.append(sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u1, v1)));
+            out.append(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u0, v1)));
+            minX = min(minX, left); maxX = max(maxX, right);
+            minY = min(minY, top); maxY = max(maxY, bottom);
+            x += g.advance;
+        }
+        if (first == out.getVertexCount()) return;
+        sf::Vector2f shift(center.x - (maxX - minX) / 2.0f, center.y - (maxY - minY) / 2.0f + yOffset);
+        for (size_t v = first; v < out.getVertexCount(); ++v) out[v].position += shift;
+    }
+};
+
+// Wheel to zoom, left-drag to pan. handle() applies one window event to the view and
+// returns true when the window needs a redraw.
+class ViewController {
+public:
+    bool moved = false;                 // the user has zoomed or panned at least once
+
+    bool handle(sf::RenderWindow &window, sf::View &view, const sf::Event &ev) {
+        if (ev.type == sf::Event::Closed) {
+            window.close();
+        } else if (ev.type == sf::Event::MouseWheelScrolled) {
+            float zoomFactor = (ev.mouseWheelScroll.delta > 0) ? 0.9f : 1.1f;
+            view.zoom(zoomFactor);
+            moved = true;
+            return true;
+        } else if (ev.type == sf::Event::MouseButtonPressed && ev.mouseButton.button == sf::Mouse::Left) {
+            dragging = true;
+            prevMousePos = sf::Mouse::getPosition(window);
+        } else if (ev.type == sf::Event::MouseButtonReleased && ev.mouseButton.button == sf::Mouse::Left) {
+            dragging = false;
+        } else if (ev.type == sf::Event::MouseMoved && dragging) {
+            sf::Vector2i newMousePos = sf::Mouse::getPosition(window);
+            sf::Vector2f delta = window.mapPixelToCoords(prevMousePos) - window.mapPixelToCoords(newMousePos);
+            view.move(delta);
+            prevMousePos = newMousePos;
+            moved = true;
+            return true;
+        } else if (ev.type == sf::Event::Resized || ev.type == sf::Event::GainedFocus) {
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool dragging = false;
+    sf::Vector2i prevMousePos;
+};
+
+// Interactive window over the tree: wheel to zoom, left-drag to pan
+inline void visualizeTree(const TreeNode *root) {
+    const int windowWidth = 1200;
+    const int windowHeight = 800;
+    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Decision Tree");
+
+    sf::Font font;
+    if (!font.loadFromFile("DejaVuSans.ttf")) {
+        cerr << "ERROR: Could not load font \"DejaVuSans.ttf\". Place it in working directory.\n";
+        return;
+    }
+
+    TreeLayout layout(root);
+    sf::View view(toRect(layout.bounds()));
+    view.setViewport(sf::FloatRect(0, 0, 1, 1));
+
+    TreeScene scene(layout, font);
+    window.setVerticalSyncEnabled(true);
+    ViewController controller;
+
+    // Sleep in waitEvent until something happens, apply every queued event, then
+    // draw one frame; vsync caps redraws at the display rate while dragging.
+    bool dirty = true;
+    while (window.isOpen()) {
+        sf::Event ev;
+        if (!dirty && !window.waitEvent(ev)) break;
+        bool have = !dirty;
+        while (have || window.pollEvent(ev)) {
+            have = false;
+            dirty |= controller.handle(window, view, ev);
+        }
+        if (!window.isOpen()) break;
+        if (!dirty) continue;
+
+        window.clear(sf::Color::White);
+        window.setView(view);
+        scene.draw(window);
+        window.display();
+        dirty = false;
+    }
+}
+
+// ————————————————————————————————————————————————————————————————————————————————
+// LiveTree: the viewer's copy of a TrainingFeed. consume() copies new events without
+// touching the builder; rebuild() turns every event so far into TreeNodes in a fresh
+// arena and lays them out again, since one new node can shift the whole tidy layout.
+// Nodes still being expanded show as internal nodes with only their finished children.
+// ————————————————————————————————————————————————————————————————————————————————
+class LiveTree {
+public:
+    size_t size() const { return events.size(); }
+    TreeLayout::Box bounds() const { return box; }
+    TreeLayout::Point latest() const { return newest; }
+
+    void consume(const TrainingFeed &feed, size_t upTo) {
+        events.reserve(upTo);
+        for (size_t i = events.size(); i < upTo; ++i) events.push_back(feed[i]);
+    }
+
+    void rebuild(const sf::Font &font) {
+        if (events.empty()) return;
+        auto next = make_unique<NodeArena>();
+        vector<uint32_t> fanOut(events.size(), 0);
+        for (auto const &e : events)
+            if (e.parent != TrainingFeed::NoNode) ++fanOut[e.parent];
+        vector<TreeNode*> nodes(events.size());
+        for (size_t i = 0; i < events.size(); ++i) {
+            nodes[i] = events[i].leaf ? next->make<TreeNode>(LeafLabel{events[i].label})
+                                      : next->make<TreeNode>(events[i].attribute);
+            if (fanOut[i]) nodes[i]->children = next->makeArray<TreeEdge>(fanOut[i]);
+            if (events[i].parent == TrainingFeed::NoNode) continue;
+            TreeNode *parent = nodes[events[i].parent];
+            parent->children[parent->childCount++] = TreeEdge{events[i].edge, nodes[i]};
+        }
+
+        scene.reset();                  // it points into the old arena
+        TreeLayout layout(nodes[0]);
+        box = layout.bounds();
+        newest = layout.nodes()[layout.indexOf(nodes.back())].position;
+        scene = make_unique<TreeScene>(layout, font);
+        arena = std::move(next);
+    }
+
+    void draw(sf::RenderTarget &target) {
+        if (scene) scene->draw(target);
+    }
+
+private:
+    vector<TrainingFeed::Event> events;
+    unique_ptr<NodeArena> arena;
+    unique_ptr<TreeScene> scene;
+    TreeLayout::Box box{};
+    TreeLayout::Point newest{};
+};
+
+// Window over a training run in progress: shows the tree as the builder grows it and
+// rings the node created last. Layout is O(nodes), so it is redone at most every
+// 200 ms and never more than a fifth of the time; the view follows the whole tree
+// until the user zooms or pans. Once the feed finishes this is the usual idle viewer.
+inline void visualizeTraining(const TrainingFeed &feed) {
+    const int windowWidth = 1200;
+    const int windowHeight = 800;
+    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Decision Tree (training)");
+
+    sf::Font font;
+    if (!font.loadFromFile("DejaVuSans.ttf")) {
+        cerr << "ERROR: Could not load font \"DejaVuSans.ttf\". Place it in working directory.\n";
+        return;
+    }
+
+    window.setVerticalSyncEnabled(true);
+    sf::View view;
+    view.setViewport(sf::FloatRect(0, 0, 1, 1));
+    ViewController controller;
+    LiveTree live;
+
+    sf::CircleShape marker(TreeStyle::NodeRadius + 6.0f);
+    marker.setOrigin(TreeStyle::NodeRadius + 6.0f, TreeStyle::NodeRadius + 6.0f);
+    marker.setFillColor(sf::Color::Transparent);
+    marker.setOutlineColor(sf::Color(255, 140, 0));
+    marker.setOutlineThickness(3.0f);
+
+    using Clock = chrono::steady_clock;
+    const Clock::duration minInterval = chrono::milliseconds(200);
+    Clock::duration interval = minInterval;
+    Clock::time_point lastLayout = Clock::now() - interval;
+
+    bool dirty = true;
+    while (window.isOpen()) {
+        bool finished = feed.finished();
+        size_t available = feed.size();
+        bool settled = finished && live.size() == available;
+
+        sf::Event ev;
+        if (settled && !dirty) {
+            if (!window.waitEvent(ev)) break;
+            dirty |= controller.handle(window, view, ev);
+        }
+        while (window.pollEvent(ev)) dirty |= controller.handle(window, view, ev);
+        if (!window.isOpen()) break;
+
+        if (available > live.size() && (finished || Clock::now() - lastLayout >= interval)) {
+            Clock::time_point start = Clock::now();
+            live.consume(feed, available);
+            live.rebuild(font);
+            lastLayout = Clock::now();
+            interval = max(minInterval, 4 * (lastLayout - start));
+            if (!controller.moved) view.reset(toRect(live.bounds()));
+            marker.setPosition(live.latest().x, live.latest().y);
+
+            string title = "Decision Tree (" + to_string(live.size()) + " nodes";
+            if (!finished) {
+                auto progress = TrainingProgress::global().snapshot();
+                title += ", training: " + to_string(static_cast<int>(progress.fraction() * 100.0)) +
+                         "% of rows resolved, depth " + to_string(progress.depth);
+            }
+            window.setTitle(title + ")");
+            dirty = true;
+        }
+
+        if (dirty) {
+            window.clear(sf::Color::White);
+            window.setView(view);
+            live.draw(window);
+            if (!finished || live.size() < available) window.draw(marker);
+            window.display();
+            dirty = false;
+        } else if (!settled) {
+            sf::sleep(sf::milliseconds(15));
+        }
+    }
+}
+
+// Train on a background thread while this thread runs the live window (SFML windows
+// belong on the main thread). Closing the window early waits for training to finish.
+inline unique_ptr<DecisionTree> trainWithLiveView(DataSheet *data) {
+    unique_ptr<DecisionTree> tree;
+    TrainingFeed &feed = TrainingFeed::global();
+    feed.enable();
+    thread builder([&] {
+        tree = make_unique<DecisionTree>(data);
+        feed.finish();
+    });
+    visualizeTraining(feed);
+    if (!feed.finished()) cout << "Waiting for training to finish...\n";
+    builder.join();
+    return tree;
+}